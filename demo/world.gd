@@ -19,52 +19,93 @@ onready var gab_options = {
 		'ZMQ_CONFLATE': 0  # only keep last message in send/receive queues (others are dropped)
 	},
 	
+	# native publish scheduler settings (see register_topic)
+	'scheduler': {
+		'bandwidth_limit': 0,  # bytes/sec shared by all registered topics (0 = unlimited); low priority topics degrade first
+		'max_topics_per_frame': 0  # spreads due topics across frames (0 = unlimited)
+	},
+	
+	# low-latency settings for dedicated hosts (trade CPU for latency). omitted settings (and negative CPUs) keep ZeroMQ/OS defaults.
+	'performance': {
+		'io_threads': 1,  # number of ZeroMQ io threads (these perform all network I/O; at least 1)
+		'io_thread_cpus': [],  # CPUs the ZeroMQ io threads are pinned to
+		# 'io_thread_priority': 50,  # ZeroMQ io thread SCHED_FIFO priority (Linux only; skipped with a warning without privileges)
+		'listener_cpu': -1,  # CPU the listener thread is pinned to
+		# 'listener_priority': 50,  # listener thread priority (Linux: SCHED_FIFO priority, needs privileges; Windows: THREAD_PRIORITY_*)
+		'busy_poll_us': 0  # microseconds the listener spins after each request before blocking again (0 = never spin)
+	},
+	
+	# consumer-driven publication rate. with 'credit' enabled, messages are only published while consumers have granted credit
+	# (see scripts/python/subscriber.py --credit); otherwise they are held (latest per topic) and send() returns "queued".
+	'flow_control': {
+		'credit': false,  # enables credit-based flow control
+		'initial_credit': 0,  # credit available before the first grant
+		'max_credit': 1000,  # upper bound on accumulated credit (per topic, and for credit shared by all topics)
+		'backpressure_threshold': 10  # consecutive undelivered messages on a topic before the "backpressure" signal is emitted
+	},
+	
 	# controls Godot-AI-Bridge's console verbosity level (larger numbers -> greater verbosity)
 	'verbosity': 3   # supported values (-1=FATAL; 0=ERROR; 1=WARNING; 2=INFO; 3=DEBUG; 4=TRACE)
 }
 
 
+# agent transforms at the start of each episode (by agent id)
+onready var initial_transforms = {}
+
+# state publication rate (in Hz), lowered for each topic whose consumers cannot keep up
+const PUBLISH_RATE = 10.0
+const MIN_PUBLISH_RATE = 1.0
+
+# registered agent topics (by topic): the agent that provides the topic's state and its current publication rate
+onready var topic_agents = {}
+onready var topic_rates = {}
+
+
 func _ready():
+	for agent in $Agents.get_children():
+		initial_transforms[agent.id] = agent.transform
 	
 	# initialize Godot-AI-Bridge
 	gab.connect(gab_options)
 
-	# initializes a timer that controls the frequency of environment state broadcasts
-	_create_publish_timer(0.1)
-
+	# registers each agent's state with Godot-AI-Bridge's native publish scheduler
+	for agent in $Agents.get_children():
+		
+		# topics characterize message content. recipients can use topics to filter messages (e.g., by agent id)
+		var topic = '/demo/agent/%s' % agent.id
+		topic_agents[topic] = agent
+		_register_agent_topic(topic, PUBLISH_RATE)
 
-func _create_publish_timer(wait_time):
-	var publish_timer = Timer.new()
 
-	publish_timer.wait_time = wait_time  
-	publish_timer.connect("timeout", self, "_on_publish_state")
-	add_child(publish_timer)
-	publish_timer.start()
+func _register_agent_topic(topic, rate):
+	topic_rates[topic] = rate
+	
+	# the scheduler calls agent.get_state() at the requested rate (in Hz) and broadcasts the result to all clients.
+	# Godot-AI-Bridge wraps this state into the "data" element of a JSON-encoded message. messages are also
+	# given a "header" element containing a unique sequence numbers (seqno) and timestamp in milliseconds.
+	# re-registering a topic only updates its rate and priority.
+	gab.register_topic(topic, rate, 0, funcref(topic_agents[topic], 'get_state'))
 
 
 #######################
 ### SIGNAL HANDLERS ###
 #######################
 
-# signal handler for publish_timer's "timeout" signal
-func _on_publish_state():
-	for agent in $Agents.get_children():
-		
-		# topics characterize message content. recipients can use topics to filter messages (e.g., by agent id)
-		var topic = '/demo/agent/%s' % agent.id
-		
-		# Godot-AI-Bridge wraps this state into the "data" element of a JSON-encoded message. messages are also
-		# given a "header" element containing a unique sequence numbers (seqno) and timestamp in milliseconds
-		var msg = agent.get_state()
-		
-		# broadcasts the message to all clients
-		gab.send(topic, msg)
-	
 # signal handler for Godot-AI-Bridge's "event_requested" signal
 func _on_event_requested(event_details):
 	print('Godot Environment: event request received -> "%s"' % event_details)
 
-	var event = event_details['data']['event']	
+	var data = event_details['data']
+	
+	# batched requests deliver all of their events at once (e.g., actions for every agent on one tick)
+	if data.has('events'):
+		for event in data['events']:
+			_handle_event(event)
+	else:
+		_handle_event(data['event'])
+
+
+func _handle_event(event):
 	match event['type']:
 		'action':
 			# apply action to all agents with matching id
@@ -72,6 +113,34 @@ func _on_event_requested(event_details):
 				# adds action to an agent's pending action queue
 				if event['agent'] == agent.id:				
 					agent.add_action(event['value'])
+		
+		# starts a new episode without restarting Godot (deferred, since requests arrive on Godot-AI-Bridge's listener thread)
+		'reset': call_deferred('_reset_episode')
 					
 		# default case: unrecognized actions
 		_: print('unrecogized event type: ', event['type']) 
+
+
+# signal handler for Godot-AI-Bridge's "backpressure" signal (emitted when consumers stop keeping up with a topic, and again
+# once they catch up). halving the congested topic's publication rate avoids producing state that would only be dropped.
+func _on_backpressure(backpressure_details):
+	print('Godot Environment: backpressure -> "%s"' % backpressure_details)
+	
+	# only scheduled agent topics are adjusted (backpressure is also reported for messages sent directly with gab.send)
+	var topic = backpressure_details['topic']
+	if not topic_agents.has(topic):
+		return
+	
+	if backpressure_details['active']:
+		_register_agent_topic(topic, max(topic_rates[topic] / 2.0, MIN_PUBLISH_RATE))
+	else:
+		_register_agent_topic(topic, PUBLISH_RATE)
+
+
+# restores the agents' initial state and starts a new Godot-AI-Bridge epoch (message sequence numbers restart at 1)
+func _reset_episode():
+	for agent in $Agents.get_children():
+		agent.pending_actions.clear()
+		agent.transform = initial_transforms[agent.id]
+	
+	gab.reset()
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <map>
+#include <string>
+#include <vector>
+
+// "JSON for Modern C++" (see https://github.com/nlohmann/json)
+#include <nlohmann/json.hpp>
+
+// GodotAiBridge includes
+#include "protocol.h"
+#include "share.h"
+#include "value.h"
+
+namespace gab {
+
+	// Controls how homogeneous numeric JSON arrays are unmarshaled (see "array_hint" request header element)
+	enum ArrayHint {
+		ARRAY_HINT_AUTO,  // numeric arrays become typed int/real arrays when their elements allow it
+		ARRAY_HINT_GENERIC,  // all arrays become generic arrays (no typed arrays)
+		ARRAY_HINT_INT,  // numeric arrays are forced to typed int arrays
+		ARRAY_HINT_REAL,  // numeric arrays are forced to typed real arrays
+		ARRAY_HINT_BYTE,  // numeric arrays are forced to typed byte arrays
+	};
+
+	// Element types of homogeneous numeric JSON arrays
+	enum NumericArrayType {
+		NUMERIC_ARRAY_NONE,  // empty, or contains non-numeric elements
+		NUMERIC_ARRAY_INT,  // integers (all of which fit in 32 bits)
+		NUMERIC_ARRAY_REAL,  // numbers, at least one of which is a float (integers all fit in 32 bits, all elements survive conversion to float)
+	};
+
+	ArrayHint convert_array_hint(const std::string& v);
+
+	// returns the unmarshaling hint for numeric arrays from a request's header (defaults to ARRAY_HINT_AUTO)
+	ArrayHint get_array_hint(const nlohmann::json& request);
+
+	NumericArrayType get_numeric_array_type(const nlohmann::json& value);
+
+	// returns true if v survives conversion to a 32-bit float (exactly, or as the same decimal number within float's precision)
+	bool is_float_representable(double v);
+
+	/* JsonWriter Class
+	*
+	*  Description: A ValueVisitor that encodes the visited value as a JSON document (typed arrays become JSON arrays).
+	*****************************************************************************************************************************************/
+	class JsonWriter : public ValueVisitor {
+	private:
+		nlohmann::json& root;
+		std::vector<nlohmann::json*> containers;  // open arrays/dictionaries (innermost last)
+		std::string key;  // key of the next dictionary value
+
+		nlohmann::json& next_element();  // the element the next visited value is written to
+
+	public:
+		explicit JsonWriter(nlohmann::json& marshaler);
+
+		void visit_nil() override;
+		void visit_bool(bool v) override;
+		void visit_int(int64_t v) override;
+		void visit_real(double v) override;
+		void visit_string(const std::string& v) override;
+
+		void begin_array(size_t size) override;
+		void end_array() override;
+
+		void begin_dictionary(size_t size) override;
+		void visit_key(const std::string& key) override;
+		void end_dictionary() override;
+
+		void visit_int_array(const int32_t* p_elements, size_t size) override;
+		void visit_real_array(const float* p_elements, size_t size) override;
+		void visit_byte_array(const uint8_t* p_elements, size_t size) override;
+	};
+
+	/* JsonValue Class
+	*
+	*  Description: A Value backed by a JSON document. Homogeneous numeric arrays are reported as typed arrays according to the array
+	*               hint, and JSON binary values as byte arrays (binary values only occur in documents built in-process, e.g. from
+	*               CBOR or MessagePack; requests received by the listener are text JSON).
+	*****************************************************************************************************************************************/
+	class JsonValue : public Value {
+	private:
+		const nlohmann::json& value;
+		ArrayHint hint;
+
+	public:
+		JsonValue(const nlohmann::json& value, ArrayHint hint = ARRAY_HINT_AUTO);
+
+		void accept(ValueVisitor& visitor) const override;
+	};
+
+	// encodes any Value as a JSON document
+	void encode_value(const Value& value, nlohmann::json& marshaler);
+
+	// describes a JSON document to visitor (see JsonValue)
+	void decode_json(const nlohmann::json& value, ValueVisitor& visitor, ArrayHint hint = ARRAY_HINT_AUTO);
+};
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// "JSON for Modern C++" (see https://github.com/nlohmann/json)
+#include <nlohmann/json.hpp>
+
+// GodotAiBridge includes
+#include "share.h"
+
+namespace gab {
+
+	// constants - flow control related
+	static const int64_t DEFAULT_INITIAL_CREDIT = 0;  // credit available when credit-based flow control starts (before any grants)
+	static const int64_t DEFAULT_MAX_CREDIT = 1000;  // upper bound on the credit a topic (or the shared pool) can accumulate
+	static const int DEFAULT_BACKPRESSURE_THRESHOLD = 10;  // consecutive undelivered messages on a topic before backpressure is reported
+
+	// Outcome of a request to publish a message
+	enum PublishStatus {
+		PUBLISH_SENT,  // handed to the publisher socket
+		PUBLISH_DROPPED,  // received by nobody (no consumer subscribed to the topic, or ZMQ_XPUB_NODROP and a full send queue)
+		PUBLISH_QUEUED,  // held until a consumer grants credit (replaces any message already held for the topic)
+		PUBLISH_ERROR,  // not sent due to an error (e.g., the data could not be serialized). not counted as backpressure.
+	};
+
+	const char* get_publish_status_name(PublishStatus status);  // "sent", "dropped", "queued" or "error"
+
+	// Pool an acquired publication credit was taken from (see FlowController::try_acquire)
+	enum CreditSource {
+		CREDIT_NONE,  // credit-based flow control is disabled (no credit was taken)
+		CREDIT_TOPIC,  // credit granted to the topic
+		CREDIT_SHARED,  // credit shared by all topics
+	};
+
+	// Changes in a topic's backpressure state (see FlowController::record)
+	enum BackpressureChange {
+		BACKPRESSURE_UNCHANGED,
+		BACKPRESSURE_STARTED,  // the topic's consecutive undelivered messages reached the backpressure threshold
+		BACKPRESSURE_ENDED,  // a message was delivered on a topic that was under backpressure
+	};
+
+	/* FlowControlOptions Struct
+	*
+	*  Description: Settings from the "flow_control" section of connect's options.
+	*****************************************************************************************************************************************/
+	struct FlowControlOptions {
+		bool is_credit_enabled = false;  // messages are only published while consumers have granted credit
+		int64_t initial_credit = DEFAULT_INITIAL_CREDIT;  // shared credit available before the first grant
+		int64_t max_credit = DEFAULT_MAX_CREDIT;
+		int backpressure_threshold = DEFAULT_BACKPRESSURE_THRESHOLD;
+
+		bool operator==(const FlowControlOptions& other) const {
+			return is_credit_enabled == other.is_credit_enabled && initial_credit == other.initial_credit && max_credit == other.max_credit
+				&& backpressure_threshold == other.backpressure_threshold;
+		}
+	};
+
+	/* FlowController Class
+	*
+	*  Description: Credit-based flow control and backpressure detection for published messages. Consumers grant credits over the
+	*               listener channel, either for a single topic or for a shared pool usable by any topic; publishing a message consumes
+	*               one credit (topic credit first). Credits are shared by all subscribers, so typically a single consumer grants them.
+	*               Messages published without credit are held (latest per topic) until credit arrives. Independently of credit mode,
+	*               consecutive undelivered messages on a topic are counted so sustained backpressure can be reported.
+	*
+	*               Grants arrive on the listener thread; all other methods are called on the publishing (main) thread.
+	*****************************************************************************************************************************************/
+	class FlowController {
+	private:
+		mutable std::mutex mutex;  // guards the credit balances (granted on the listener thread, consumed on the main thread)
+		std::map<std::string, int64_t> topic_credits;  // credit granted to individual topics
+		int64_t shared_credit;  // credit usable by any topic
+
+		FlowControlOptions options;
+
+		std::map<std::string, nlohmann::json> pending;  // latest message held for each topic without credit (main thread only)
+		std::map<std::string, int> undelivered;  // consecutive undelivered messages by topic (main thread only)
+
+	public:
+		FlowController();
+
+		void configure(const FlowControlOptions& options);  // also discards all credit and held messages
+		bool is_credit_enabled() const;
+
+		int64_t grant(const std::string& topic, int64_t n);  // adds credit to topic (or to the shared pool if topic is empty). returns the new balance.
+		bool has_credit(const std::string& topic) const;
+		bool try_acquire(const std::string& topic, CreditSource& source_out);  // consumes one credit for topic if available
+		void release(const std::string& topic, CreditSource source);  // returns an acquired credit to the pool it was taken from (e.g., when its message was dropped)
+		void clear_credit();  // restores the initial credit
+
+		void hold(const std::string& topic, nlohmann::json&& message);
+		bool take_held(const std::string& topic, nlohmann::json& message_out);  // removes and returns the message held for topic
+		void discard_held(const std::string& topic);
+		void clear_held();
+		void collect_held_topics(std::vector<std::string>& topics_out) const;
+
+		BackpressureChange record(const std::string& topic, PublishStatus status);  // tracks consecutive undelivered messages (errors are ignored)
+		int get_undelivered(const std::string& topic) const;
+		void clear_backpressure();
+	};
+};
@@ -1,15 +1,13 @@
 #pragma once
 
-#if defined(_WIN32)
-	#pragma comment(lib, "ws2_32.lib")
-	#pragma comment(lib, "Advapi32.lib")
-	#pragma comment(lib, "Iphlpapi.lib")
-#endif
-
+#include <atomic>
+#include <functional>
 #include <sstream>
 #include <stdexcept>
 #include <stdio.h>
 #include <thread>
+#include <vector>
+#include <set>
 #include <cerrno>
 #include <chrono>
 
@@ -18,6 +16,7 @@
 #include <Node.hpp>
 #include <Array.hpp>
 #include <String.hpp>
+#include <FuncRef.hpp>
 
 // cppzmq includes
 #include <zmq.hpp> 
@@ -25,100 +24,25 @@
 // GodotAiBridge includes
 #include "util.h"
 #include "share.h"
+#include "protocol.h"
+#include "transport.h"
+#include "scheduler.h"
+#include "snapshot.h"
+#include "flow.h"
 
 namespace gab {
 
-	using json = nlohmann::json;
-
 	// forward declarations
 	class GodotAiBridge;
-	class Listener;
-	class Publisher;
-
-	// constants - connection related
-	static const int DEFAULT_PUBLISHER_PORT = 10001;  // this port will be used for the publisher unless otherwise specified in Godot socket_options
-	static const int DEFAULT_LISTENER_PORT = 10002;  // this port will be used for the listener unless otherwise specified in Godot socket_options
-
-	static const std::map<int, int> DEFAULT_PUBLISHER_OPTIONS = {
-	{ZMQ_SNDHWM, 10},  // send high watermark (messages dropped when high watermark exceeded)
-	{ZMQ_SNDTIMEO, 250},  // send timeout in milliseconds
-	};
-
-	static const std::map<int, int> DEFAULT_LISTENER_OPTIONS = {
-		{ZMQ_RCVTIMEO, 250}, // receive timeout in milliseconds
-		{ZMQ_LINGER, 0}, // pending messages discarded immediately on socket close
-		{ZMQ_RCVHWM, 10}, // receive high watermark (messages dropped when high watermark exceeded)
-		{ZMQ_REQ_RELAXED, 1}, // relax strict alternation between request and reply
-		{ZMQ_REQ_CORRELATE, 1}, // adds extra frame to requests and replies for matching purposes
-
-	};
-
-	// constants - message elements
-	static const char* MSG_HEADER = "header";
-	static const char* MSG_DATA = "data";
-
-	// constants - header elements
-	static const char* SEQNO = "seqno";
-	static const char* TIME = "time";
-
-	// shared verbosity variable
-	static int verbosity = 0;
-
-	// verbosity levels
-	static int ERROR = 0;
-	static int WARNING = 1;
-	static int INFO = 2;
-	static int DEBUG = 3;
-	static int TRACE = 4;
-
-	/* Listener Class
-	* 
-	*  Description: Receives Godot external requests for environment events (e.g., agent actions, or agents joining/leaving the environment).
-	*****************************************************************************************************************************************/
-	class Listener {
-	private:
-		zmq::socket_t* p_socket;  // ZeroMq socket backing this connection
-		uint16_t port;  // network port number used for socket connection
-		uint64_t seqno;  // request sequence numbers
-
-		GodotAiBridge& bridge;  // used to communicate with Godot engine (e.g., sending signals)
-
-		zmq::message_t create_reply(const uint64_t seqno, const std::string& parse_errors);
-	public:
-
-		Listener(zmq::context_t& zmq_context, std::map<int, int> socket_options, uint16_t port, GodotAiBridge& bridge);
-
-		void operator()();
-		void receive(const zmq::message_t& request);
-	};
-
-	/* Publisher Class
-	*
-	*  Description: Broadcasts messages from Godot (e.g., agent state information) to external consumers.
-	*****************************************************************************************************************************************/
-	class Publisher {
-	private:
-		zmq::socket_t* p_socket;  // ZeroMq socket backing this connection
-		uint16_t port;  // network port number used for socket connection
-		uint64_t seqno;  // published message sequence numbers
-
-		void construct_message(zmq::message_t& msg, const std::string& topic, const std::string& payload);
-		size_t get_message_length(const std::string& topic, const std::string& msg);
-
-	public:
-		Publisher(zmq::context_t& zmq_context, std::map<int, int> socket_options, uint16_t port);
-
-		void publish(const std::string& topic, const std::string& content);
-		uint64_t get_seqno();
-	};
 
 	/* GodotAiBridge Class (subclass of godot::Node)
 	*
 	*  Description: A Godot Node that functions as the interface between the Godot engine and the communication middleware provided by
 	*               this library. It provides the mechanism by which environment state can be sent to Godot external clients, and events
-	*               can be requested and sent to Godot from those clients.
+	*               can be requested and sent to Godot from those clients. Marshaling and transport live in the engine-independent core
+	*               (codec.h, transport.h); this class adapts them to Godot's Variants, signals and scene tree.
 	*****************************************************************************************************************************************/
-	class GodotAiBridge : public godot::Node {
+	class GodotAiBridge : public godot::Node, public RequestHandler {
 		GODOT_CLASS(GodotAiBridge, Node);
 
 	private:
@@ -131,6 +55,32 @@ namespace gab {
 
 		std::thread* p_listener_thread;  // a thread for listener's receive loop
 
+		// settings of the current connection (a repeated call to "connect" with the same settings reuses the existing sockets)
+		int connected_publisher_port;
+		int connected_listener_port;
+		std::map<int, int> connected_publisher_options;
+		std::map<int, int> connected_listener_options;
+		PerformanceOptions connected_performance_options;
+		FlowControlOptions connected_flow_options;
+
+		bool is_context_started;  // zmq context options only take effect before the first socket is created
+
+		std::atomic<uint64_t> epoch;  // incremented by each reset (included in all message headers)
+
+		PublishScheduler scheduler;  // decides which registered topics are published on each frame
+		std::map<std::string, godot::Ref<godot::FuncRef>> topic_providers;  // state-provider callbacks for registered topics
+		std::vector<std::string> due_topics;  // topics due for publication on the current frame (reused across frames)
+
+		SnapshotCache snapshots;  // latest published message per topic (read by the listener thread to answer queries)
+
+		FlowController flow;  // publication credit granted by consumers, and backpressure detection
+		std::vector<std::string> held_topics;  // topics with messages held for credit (reused across frames)
+
+		PublishStatus publish(const std::string& topic, const godot::Variant& v_data, size_t& n_bytes_out);  // n_bytes_out receives the number of bytes sent
+		PublishStatus transmit(const std::string& topic, json& marshaler, CreditSource credit_source, size_t& n_bytes_out);  // adds the header and sends (credit already acquired from credit_source)
+		void publish_held();  // sends held messages for which credit has since been granted
+		void report_backpressure(const std::string& topic, PublishStatus status);  // emits the "backpressure" signal when a topic's state changes
+
 	public:
 
 		GodotAiBridge();
@@ -139,33 +89,33 @@ namespace gab {
 		// GDNative required methods
 		static void _register_methods();
 		void _init();
+		void _process(float delta);  // publishes the registered topics that are due on this frame
 
 		// GDNative exposed methods
 		void connect(godot::Variant v_options);  // initializes the network sockets and listener threads. operation can be customized via user supplied options.
-		void send(const godot::Variant v_topic, const godot::Variant v_data);  // sends a message from Godot engine to external clients on the specified message topic.
-		void notify(const zmq::message_t& request, std::string& parse_errors);  // emits a signal to Godot along with the requested event details
+		godot::String send(const godot::Variant v_topic, const godot::Variant v_data);  // sends a message from Godot engine to external clients on the specified message topic (non-empty, without spaces). returns "sent", "dropped" (nobody received it), "queued" or "error".
+		void register_topic(const godot::Variant v_topic, const godot::Variant v_rate, const godot::Variant v_priority, const godot::Variant v_provider);  // publishes a FuncRef's result on topic at rate (in Hz)
+		void unregister_topic(const godot::Variant v_topic);  // stops the scheduled publication of a topic
+		godot::Dictionary get_topic_stats(const godot::Variant v_topic);  // scheduler statistics of a registered topic (empty if not registered)
+		void disconnect();  // stops the listener thread and closes the network sockets. "connect" may be called again afterwards.
+		void reset();  // starts a new epoch on the existing connection (sequence numbers restart and cached state is discarded)
+		bool is_connected();
+
+		// RequestHandler methods (called on the listener thread)
+		void notify(json& request, std::string& parse_errors) override;  // emits a signal to Godot along with the requested event details
+		void notify_batch(json& request, std::vector<std::string>& event_errors) override;  // emits one signal to Godot for all valid events in a batch
+
+		std::shared_ptr<const std::string> get_snapshot(const std::string& topic) const override;  // latest message published on topic (thread-safe)
+		int64_t grant_credit(const std::string& topic, int64_t n) override;  // adds publication credit (credit-based flow control only)
+		uint64_t get_epoch() const override;
 	};
 
-	// Maps socket options from Godot Dictionary to a std::map usable by ZeroMQ
-	void map_options(const godot::Dictionary& v_options, std::map<int, int>& options_out);
-
-	inline void set_options(zmq::socket_t& socket, std::map<int, int>& socket_options) {
-		for (std::map<int, int>::iterator it = socket_options.begin(); it != socket_options.end(); ++it) {
-			zmq_setsockopt(socket, it->first, &it->second, sizeof(it->second));
-		}
-	}
-
-	inline std::string construct_endpoint(int port) {
-		return "tcp://*:" + std::to_string(port);
-	}
+	// Maps socket options from Godot Dictionary to a std::map usable by ZeroMQ (publisher-only options are skipped unless is_publisher)
+	void map_options(const godot::Dictionary& v_options, std::map<int, int>& options_out, bool is_publisher);
 
-	inline void construct_message_header(json& marshaler, uint64_t seqno)
-	{
-		using std::chrono::duration_cast;
-		using std::chrono::system_clock;
-		using std::chrono::milliseconds;		
+	// Maps the "performance" section of connect's options from a Godot Dictionary
+	void map_performance_options(const godot::Dictionary& v_options, PerformanceOptions& options_out);
 
-		marshaler[SEQNO] = seqno;
-		marshaler[TIME] = duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count();
-	}
+	// Maps the "flow_control" section of connect's options from a Godot Dictionary
+	void map_flow_control_options(const godot::Dictionary& v_options, FlowControlOptions& options_out);
 };
\ No newline at end of file
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <deque>
+#include <map>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// cppzmq includes
+#include <zmq.hpp>
+
+// GodotAiBridge includes
+#include "protocol.h"
+#include "share.h"
+
+/* Godot-AI-Bridge C++ client library (libgab_client)
+*
+*  Description: Native counterparts of scripts/python/client.py and subscriber.py for trainers and load generators. Uses the same
+*               framing and encoding code (protocol.h) as the GDNative library and does not depend on godot-cpp.
+*****************************************************************************************************************************************/
+namespace gab {
+
+	// constants - client related
+	static const char* DEFAULT_HOST = "localhost";
+	static const int DEFAULT_CLIENT_TIMEOUT = 5000;  // in milliseconds
+	static const size_t DEFAULT_MAX_IN_FLIGHT = 64;  // maximum number of pipelined requests awaiting replies
+
+	/* StateMessage Class
+	*
+	*  Description: A message received from the Godot-AI-Bridge publisher. The topic and payload are views into the received frame
+	*               (no copies), and any additional frames (e.g., binary attachments) are accessible as received.
+	*****************************************************************************************************************************************/
+	class StateMessage {
+	private:
+		std::vector<zmq::message_t> frames;  // received frames (reused across receives)
+		size_t n_frames;  // number of frames in the current message
+
+		std::string_view topic;
+		std::string_view payload;
+
+		friend class StateSubscriber;
+
+	public:
+		StateMessage();
+
+		std::string_view get_topic() const;
+		std::string_view get_payload() const;  // JSON-encoded message (header and data elements)
+		json parse() const;  // unmarshals the JSON payload
+
+		size_t get_frame_count() const;
+		const zmq::message_t& get_frame(size_t ndx) const;  // frame 0 holds "<TOPIC> <JSON>", later frames are binary attachments
+	};
+
+	/* StateSubscriber Class
+	*
+	*  Description: Receives messages broadcast by the Godot-AI-Bridge publisher (SUB socket).
+	*****************************************************************************************************************************************/
+	class StateSubscriber {
+	private:
+		zmq::socket_t socket;
+
+	public:
+		StateSubscriber(zmq::context_t& zmq_context, const std::string& host = DEFAULT_HOST, int port = DEFAULT_PUBLISHER_PORT);
+
+		void subscribe(const std::string& topic_prefix = "");  // an empty prefix receives all topics
+		void unsubscribe(const std::string& topic_prefix = "");
+
+		bool receive(StateMessage& message_out, int timeout = DEFAULT_CLIENT_TIMEOUT);  // returns false if timeout (in milliseconds) expired
+	};
+
+	/* ActionSender Class
+	*
+	*  Description: Sends requests to the Godot-AI-Bridge listener without waiting for each reply (DEALER socket). Up to max_in_flight
+	*               requests are pipelined; replies arrive in request order.
+	*****************************************************************************************************************************************/
+	class ActionSender {
+	private:
+		zmq::socket_t socket;
+		uint64_t seqno;  // request sequence numbers
+		size_t max_in_flight;
+		std::deque<uint64_t> in_flight;  // sequence numbers of requests awaiting replies (oldest first)
+		std::deque<std::pair<uint64_t, json>> received;  // replies read while waiting for room or flushing, not yet returned by receive (oldest first)
+
+		bool receive_from_socket(json& reply_out, uint64_t& seqno_out, int timeout);  // reads the oldest in-flight request's reply
+		void collect_reply(int timeout);  // reads the oldest in-flight request's reply into received (throws on timeout)
+
+	public:
+		ActionSender(zmq::context_t& zmq_context, const std::string& host = DEFAULT_HOST, int port = DEFAULT_LISTENER_PORT, size_t max_in_flight = DEFAULT_MAX_IN_FLIGHT);
+
+		// sends a request with the given data element and returns its sequence number. when max_in_flight requests are pending, the
+		// oldest reply is awaited first (and kept for receive, so ERROR replies and batch results are never lost).
+		uint64_t send(const json& data, int timeout = DEFAULT_CLIENT_TIMEOUT);
+		uint64_t send_event(const json& event, int timeout = DEFAULT_CLIENT_TIMEOUT);
+		uint64_t send_events(const json& events, int timeout = DEFAULT_CLIENT_TIMEOUT);  // one batched request for many events
+		uint64_t send_query(const std::string& topic, int timeout = DEFAULT_CLIENT_TIMEOUT);
+		uint64_t send_credit(int64_t n, const std::string& topic = "", int timeout = DEFAULT_CLIENT_TIMEOUT);  // grants publication credit (shared by all topics if topic is empty)
+
+		// receives the oldest reply not yet returned (replies already read by send or flush first). returns false if timeout (in
+		// milliseconds) expired.
+		bool receive(json& reply_out, uint64_t& seqno_out, int timeout = DEFAULT_CLIENT_TIMEOUT);
+
+		// sends a request and waits for its reply (replies of older requests are kept for receive)
+		json request(const json& data, int timeout = DEFAULT_CLIENT_TIMEOUT);
+
+		size_t get_in_flight() const;  // requests awaiting replies
+		size_t get_received() const;  // replies already read but not yet returned by receive
+		void flush(int timeout = DEFAULT_CLIENT_TIMEOUT);  // waits for all pending replies (they remain available to receive)
+		void discard_received();  // drops the replies not yet returned by receive
+	};
+
+	/* VectorEnv Class
+	*
+	*  Description: Drives many agents of one Godot-AI-Bridge environment together. Each step sends the events of all agents in one
+	*               batched request, and the latest published state of every subscribed topic is kept as that topic's observation.
+	*****************************************************************************************************************************************/
+	class VectorEnv {
+	private:
+		zmq::context_t zmq_context;
+		StateSubscriber subscriber;
+		ActionSender sender;
+
+		StateMessage message;  // reused receive buffer
+		std::unordered_map<std::string, json> observations;  // latest message by topic
+
+	public:
+		VectorEnv(const std::vector<std::string>& topics, const std::string& host = DEFAULT_HOST,
+			int publisher_port = DEFAULT_PUBLISHER_PORT, int listener_port = DEFAULT_LISTENER_PORT);
+
+		json step(const std::vector<json>& events, int timeout = DEFAULT_CLIENT_TIMEOUT);  // returns the batch reply (one result per event)
+		size_t poll(int timeout = 0);  // receives pending messages into observations (returns the number received)
+
+		const json* get_observation(const std::string& topic) const;  // nullptr if nothing received on topic
+		json query(const std::string& topic, int timeout = DEFAULT_CLIENT_TIMEOUT);  // latest state from the listener's snapshot cache
+		json grant_credit(int64_t n, const std::string& topic = "", int timeout = DEFAULT_CLIENT_TIMEOUT);  // for environments using credit-based flow control
+	};
+};
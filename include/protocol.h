@@ -0,0 +1,181 @@
+#pragma once
+
+#include <chrono>
+#include <map>
+#include <string>
+#include <string.h>
+#include <string_view>
+
+// "JSON for Modern C++" (see https://github.com/nlohmann/json)
+#include <nlohmann/json.hpp>
+
+// cppzmq includes
+#include <zmq.hpp>
+
+// GodotAiBridge includes
+#include "share.h"
+
+/* Godot-AI-Bridge wire protocol
+*
+*  Description: Message framing and encoding shared by the GDNative library and the C++ client library (no godot-cpp dependencies).
+*               Published messages are single frames of the form "<TOPIC> <JSON>". Requests and replies are JSON objects with a
+*               "header" element (sequence number, epoch, and timestamp) and a "data" element.
+*****************************************************************************************************************************************/
+namespace gab {
+
+	// constants - connection related
+	static const int DEFAULT_PUBLISHER_PORT = 10001;  // this port will be used for the publisher unless otherwise specified in Godot socket_options
+	static const int DEFAULT_LISTENER_PORT = 10002;  // this port will be used for the listener unless otherwise specified in Godot socket_options
+
+	// constants - message elements
+	static const char* MSG_HEADER = "header";
+	static const char* MSG_DATA = "data";
+
+	// constants - header elements
+	static const char* SEQNO = "seqno";
+	static const char* TIME = "time";
+	static const char* EPOCH = "epoch";  // incremented by each reset (sequence numbers restart at 1 in every epoch)
+	static const char* ARRAY_HINT = "array_hint";  // optional request header element (one of "auto", "generic", "int", "real", or "byte")
+
+	// constants - request data elements
+	static const char* EVENT = "event";  // a single event delivered to Godot
+	static const char* QUERY = "query";  // requests the latest message published on a topic (answered by the listener thread)
+	static const char* EVENTS = "events";  // batch of events delivered to Godot as one array-valued event (acknowledged by one reply)
+	static const char* CREDIT = "credit";  // grants publication credit (credit-based flow control, answered by the listener thread)
+	static const char* CREDIT_TOPIC = "topic";  // optional topic of a credit grant (credit is shared by all topics if omitted)
+
+	// constants - reply data elements
+	static const char* REPLY_STATUS = "status";
+	static const char* REPLY_REASON = "reason";  // explanation of an ERROR status
+	static const char* REPLY_RESULTS = "results";  // one status per event (batch replies)
+	static const char* REPLY_TOPIC = "topic";  // queried topic (query replies)
+	static const char* REPLY_MESSAGE = "message";  // latest message published on the queried topic (query replies)
+	static const char* REPLY_CREDIT = "credit";  // credit available after the grant (credit replies)
+
+	// constants - reply status values
+	static const char* STATUS_SUCCESS = "SUCCESS";
+	static const char* STATUS_ERROR = "ERROR";
+
+	using json = nlohmann::json;
+
+	inline void set_options(zmq::socket_t& socket, const std::map<int, int>& socket_options) {
+		for (std::map<int, int>::const_iterator it = socket_options.begin(); it != socket_options.end(); ++it) {
+			zmq_setsockopt(socket, it->first, &it->second, sizeof(it->second));
+		}
+	}
+
+	inline std::string construct_endpoint(int port) {
+		return "tcp://*:" + std::to_string(port);
+	}
+
+	inline std::string construct_endpoint(const std::string& host, int port) {
+		return "tcp://" + host + ":" + std::to_string(port);
+	}
+
+	inline void construct_message_header(json& marshaler, uint64_t seqno, uint64_t epoch)
+	{
+		using std::chrono::duration_cast;
+		using std::chrono::system_clock;
+		using std::chrono::milliseconds;		
+
+		marshaler[SEQNO] = seqno;
+		marshaler[EPOCH] = epoch;
+		marshaler[TIME] = duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count();
+	}
+
+	inline zmq::message_t construct_message(const std::string& content)
+	{
+		zmq::message_t message(content.length());
+		memcpy(message.data(), content.c_str(), content.length());
+
+		return message;
+	}
+
+	inline size_t get_topic_message_length(const std::string& topic, const std::string& payload)
+	{
+		return topic.length() + payload.length() + 1; // additional character for space between topic and json
+	}
+
+	// frames a published message as "<TOPIC> <JSON>"
+	inline zmq::message_t construct_topic_message(const std::string& topic, const std::string& payload)
+	{
+		zmq::message_t message(get_topic_message_length(topic, payload));
+		char* p_buffer = static_cast<char*>(message.data());
+
+		// add topic to buffer
+		memcpy(p_buffer, topic.c_str(), topic.length());
+
+		// add space
+		p_buffer[topic.length()] = ' ';
+
+		// add message payload to buffer
+		memcpy(p_buffer + topic.length() + 1, payload.c_str(), payload.length());
+
+		return message;
+	}
+
+	// throws if topic cannot be published (topics are separated from payloads by a space, so they must be non-empty and contain no spaces)
+	inline void validate_topic(const std::string& topic)
+	{
+		if (topic.empty()) {
+			throw GodotAiBridgeException("invalid topic (reason: topic is empty)");
+		}
+
+		if (topic.find(' ') != std::string::npos) {
+			throw GodotAiBridgeException("invalid topic (reason: topic contains a space) -> \"" + topic + "\"");
+		}
+	}
+
+	// splits a published message into views of its topic and payload (no copies). topics never contain spaces.
+	inline void split_topic_message(const zmq::message_t& message, std::string_view& topic_out, std::string_view& payload_out)
+	{
+		std::string_view content(static_cast<const char*>(message.data()), message.size());
+
+		size_t ndx = content.find(' ');
+		if (ndx == std::string_view::npos) {
+			throw GodotAiBridgeException("malformed message (reason: missing topic separator)");
+		}
+
+		topic_out = content.substr(0, ndx);
+		payload_out = content.substr(ndx + 1);
+	}
+
+	// returns true if request is a state query (i.e., its data element contains a "query" topic string)
+	inline bool is_query_request(const json& request)
+	{
+		if (request.is_object() && request.contains(MSG_DATA)) {
+			const json& data = request[MSG_DATA];
+			return data.is_object() && data.contains(QUERY) && data[QUERY].is_string();
+		}
+
+		return false;
+	}
+
+	// returns true if request is a batch of events (i.e., its data element contains an "events" array)
+	inline bool is_batch_request(const json& request)
+	{
+		if (request.is_object() && request.contains(MSG_DATA)) {
+			const json& data = request[MSG_DATA];
+			return data.is_object() && data.contains(EVENTS) && data[EVENTS].is_array();
+		}
+
+		return false;
+	}
+
+	// returns true if request grants publication credit (i.e., its data element contains an integer "credit" and no "event")
+	inline bool is_credit_request(const json& request)
+	{
+		if (request.is_object() && request.contains(MSG_DATA)) {
+			const json& data = request[MSG_DATA];
+			return data.is_object() && data.contains(CREDIT) && data[CREDIT].is_number_integer() && !data.contains(EVENT);
+		}
+
+		return false;
+	}
+
+	// returns true if a reply's status is SUCCESS
+	inline bool is_success_reply(const json& reply)
+	{
+		return reply.is_object() && reply.contains(MSG_DATA) && reply[MSG_DATA].value(REPLY_STATUS, "") == STATUS_SUCCESS;
+	}
+};
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <map>
+#include <string>
+#include <vector>
+
+// GodotAiBridge includes
+#include "share.h"
+
+namespace gab {
+
+	// constants - scheduler related
+	static const double DEFAULT_BANDWIDTH_LIMIT = 0.0;  // bytes per second shared by all scheduled topics (0 = unlimited)
+	static const size_t DEFAULT_MAX_TOPICS_PER_FRAME = 0;  // maximum number of topics published per frame (0 = unlimited)
+
+	/* PublishScheduler Class
+	*
+	*  Description: Decides which registered topics are due for publication on each frame. Topics are published at their own target
+	*               rates, with initial publication times staggered so equal-rate topics do not all fall on the same frame. When a
+	*               per-frame topic limit is reached the remaining due topics carry over to the next frame. A global bandwidth budget
+	*               (token bucket) is enforced by serving topics in priority order and skipping a publication cycle for the topics that
+	*               no longer fit, so low-priority topics are degraded first.
+	*****************************************************************************************************************************************/
+	class PublishScheduler {
+	public:
+		struct Topic {
+			std::string name;  // message topic
+			double interval;  // target seconds between publications (1 / rate)
+			int priority;  // larger values are served first when the frame or bandwidth budget is limited
+			double next_due;  // time (in seconds) when the next publication is due
+			double avg_bytes;  // moving average of published message sizes (used to estimate bandwidth use)
+			uint64_t n_published;  // number of publications
+			uint64_t n_skipped;  // number of publication cycles skipped due to the bandwidth budget
+		};
+
+	private:
+		std::map<std::string, Topic> topics;  // registered topics (by name)
+
+		double bandwidth_limit;  // bytes per second (0 = unlimited)
+		double bandwidth_credit;  // bytes currently available for publication
+		double last_refill;  // time (in seconds) when bandwidth credit was last refilled
+
+		size_t max_topics_per_frame;  // 0 = unlimited
+		uint64_t n_registrations;  // used to stagger initial publication times
+
+		void advance(Topic& topic, double now);  // moves a topic's next publication past now (keeping its phase)
+
+	public:
+		PublishScheduler();
+
+		void add_topic(const std::string& name, double rate, int priority, double now);  // registers (or updates) a topic
+		bool remove_topic(const std::string& name);
+
+		void set_bandwidth_limit(double bytes_per_second);
+		void set_max_topics_per_frame(size_t n);
+
+		void collect_due(double now, std::vector<std::string>& due_out);  // topics that should be published this frame
+		void record_published(const std::string& name, size_t bytes);  // accounts for a delivered publication's actual size
+
+		const Topic* get_topic(const std::string& name) const;  // nullptr if name is not registered
+	};
+
+	// monotonic time in seconds used for scheduling
+	inline double get_scheduler_time() {
+		using std::chrono::duration;
+		using std::chrono::steady_clock;
+
+		return duration<double>(steady_clock::now().time_since_epoch()).count();
+	}
+};
@@ -9,4 +9,14 @@ namespace gab {
 		GodotAiBridgeException(const char* const what) : std::runtime_error(what) {}
 		GodotAiBridgeException(const std::string& what): std::runtime_error(what.c_str()){}
 	};
+
+	// shared verbosity variable (one instance for all translation units)
+	inline int verbosity = 0;
+
+	// verbosity levels
+	static const int ERROR = 0;
+	static const int WARNING = 1;
+	static const int INFO = 2;
+	static const int DEBUG = 3;
+	static const int TRACE = 4;
 };
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+
+namespace gab {
+
+	/* SnapshotCache Class
+	*
+	*  Description: Holds the most recently published (already serialized) message for each topic so the listener thread can answer
+	*               state queries without involving Godot's main thread. Snapshots are immutable; publishing swaps in a new snapshot
+	*               under a brief exclusive lock and readers keep their own reference, so a slow reader never blocks the publisher
+	*               for longer than a pointer copy (read-copy-update).
+	*****************************************************************************************************************************************/
+	class SnapshotCache {
+	private:
+		mutable std::shared_mutex mutex;  // guards the topic map (not the snapshots themselves, which are immutable)
+		std::unordered_map<std::string, std::shared_ptr<const std::string>> snapshots;  // latest serialized message by topic
+
+	public:
+		void store(const std::string& topic, std::string content);
+		std::shared_ptr<const std::string> load(const std::string& topic) const;  // returns nullptr if nothing published on topic
+		void clear();
+	};
+};
@@ -0,0 +1,166 @@
+#pragma once
+
+#if defined(_WIN32)
+	#pragma comment(lib, "ws2_32.lib")
+	#pragma comment(lib, "Advapi32.lib")
+	#pragma comment(lib, "Iphlpapi.lib")
+#endif
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <optional>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+// cppzmq includes
+#include <zmq.hpp> 
+
+// GodotAiBridge includes
+#include "protocol.h"
+#include "share.h"
+
+/* Godot-AI-Bridge transport core
+*
+*  Description: The listener and publisher sockets, independent of any game engine. Engine adapters (e.g., the GDNative GodotAiBridge
+*               class) implement RequestHandler to receive events and provide cached state.
+*****************************************************************************************************************************************/
+namespace gab {
+
+	// constants - connection related
+	static const std::map<int, int> DEFAULT_PUBLISHER_OPTIONS = {
+	{ZMQ_SNDHWM, 10},  // send high watermark (messages dropped when high watermark exceeded)
+	{ZMQ_SNDTIMEO, 250},  // send timeout in milliseconds
+	{ZMQ_LINGER, 0}, // pending messages discarded immediately on socket close (allows a prompt disconnect)
+	};
+
+	static const std::map<int, int> DEFAULT_LISTENER_OPTIONS = {
+		{ZMQ_RCVTIMEO, 250}, // receive timeout in milliseconds
+		{ZMQ_LINGER, 0}, // pending messages discarded immediately on socket close
+		{ZMQ_RCVHWM, 10}, // receive high watermark (messages dropped when high watermark exceeded)
+		{ZMQ_REQ_RELAXED, 1}, // relax strict alternation between request and reply
+		{ZMQ_REQ_CORRELATE, 1}, // adds extra frame to requests and replies for matching purposes
+
+	};
+
+	/* PerformanceOptions Struct
+	*
+	*  Description: Latency-oriented settings from the "performance" section of connect's options (for dedicated hosts that trade CPU for
+	*               latency). Negative thread counts/CPUs and unset priorities leave the corresponding setting at its ZeroMQ/OS default.
+	*               Priorities have no "unset" value of their own, since every integer is a valid Windows THREAD_PRIORITY_* value.
+	*****************************************************************************************************************************************/
+	struct PerformanceOptions {
+		int io_threads = -1;  // number of zmq io threads (these threads perform the actual network I/O for the publisher and listener)
+		std::vector<int> io_thread_cpus;  // CPUs the zmq io threads are pinned to
+		std::optional<int> io_thread_priority;  // SCHED_FIFO priority of the zmq io threads (Linux only, requires privileges)
+		int listener_cpu = -1;  // CPU the listener thread is pinned to
+		std::optional<int> listener_priority;  // scheduling priority of the listener thread
+		int busy_poll_us = 0;  // microseconds the listener spins (non-blocking polls) after each request before blocking again (0 = never spin)
+
+		bool operator==(const PerformanceOptions& other) const {
+			return io_threads == other.io_threads && io_thread_cpus == other.io_thread_cpus && io_thread_priority == other.io_thread_priority
+				&& listener_cpu == other.listener_cpu && listener_priority == other.listener_priority && busy_poll_us == other.busy_poll_us;
+		}
+	};
+
+	/* RequestHandler Class (abstract)
+	*
+	*  Description: Receives the requests accepted by a Listener. Called on the listener thread.
+	*****************************************************************************************************************************************/
+	class RequestHandler {
+	public:
+		virtual ~RequestHandler() {}
+
+		virtual void notify(json& request, std::string& parse_errors) = 0;  // delivers a single event request
+		virtual void notify_batch(json& request, std::vector<std::string>& event_errors) = 0;  // delivers all valid events in a batch
+
+		virtual std::shared_ptr<const std::string> get_snapshot(const std::string& topic) const = 0;  // latest message published on topic
+		virtual int64_t grant_credit(const std::string& topic, int64_t n) = 0;  // returns the credit available afterwards (throws if refused)
+		virtual uint64_t get_epoch() const = 0;
+	};
+
+	/* Listener Class
+	* 
+	*  Description: Receives Godot external requests for environment events (e.g., agent actions, or agents joining/leaving the environment).
+	*****************************************************************************************************************************************/
+	class Listener {
+	private:
+		zmq::socket_t* p_socket;  // ZeroMq socket backing this connection
+		zmq::socket_t* p_control;  // receives shutdown requests (polled by the listener thread alongside p_socket)
+		zmq::socket_t* p_control_sender;  // sends shutdown requests (used by the thread that owns the listener)
+		uint16_t port;  // network port number used for socket connection
+		std::atomic<uint64_t> seqno;  // request sequence numbers (reset from Godot's main thread)
+		std::chrono::microseconds busy_poll_time;  // how long to spin after each request before blocking (0 = never spin)
+
+		RequestHandler& handler;  // used to communicate with the engine (e.g., sending signals)
+
+		void close_sockets();  // also used to release the sockets of a partially constructed listener
+		zmq::message_t create_reply(const uint64_t seqno, const std::string& parse_errors);
+		zmq::message_t create_query_reply(const uint64_t seqno, const std::string& topic);
+		zmq::message_t create_batch_reply(const uint64_t seqno, const std::vector<std::string>& event_errors);
+		zmq::message_t create_credit_reply(const uint64_t seqno, const json& data);
+	public:
+
+		Listener(zmq::context_t& zmq_context, std::map<int, int> socket_options, uint16_t port, RequestHandler& handler);
+		~Listener();
+
+		void operator()();
+		void receive(const zmq::message_t& request);
+		void stop();  // asks the receive loop to exit (the caller should then join the listener thread)
+		void reset_seqno();
+		void set_busy_poll_time(std::chrono::microseconds t);  // must be called before the listener thread is started
+	};
+
+	/* Publisher Class
+	*
+	*  Description: Broadcasts messages from Godot (e.g., agent state information) to external consumers. The socket is an XPUB socket, so
+	*               the publisher learns which topic prefixes consumers subscribe to and can tell when nobody receives a message.
+	*****************************************************************************************************************************************/
+	class Publisher {
+	private:
+		zmq::socket_t* p_socket;  // ZeroMq socket backing this connection
+		uint16_t port;  // network port number used for socket connection
+		uint64_t seqno;  // published message sequence numbers (dropped messages use theirs too)
+		std::set<std::string> subscriptions;  // prefixes subscribed by at least one consumer (zmq reports each prefix's first and last)
+
+		void update_subscriptions();  // applies the subscription changes consumers made since the last call
+		bool is_subscribed(const zmq::message_t& message) const;  // true if any subscription prefixes message
+
+	public:
+		Publisher(zmq::context_t& zmq_context, std::map<int, int> socket_options, uint16_t port);
+		~Publisher();
+
+		// returns false if nobody received the message (no consumer subscribed to it, or ZMQ_XPUB_NODROP is set and a consumer's high
+		// watermark was reached). throws a GodotAiBridgeException if the socket failed (e.g., its context was terminated).
+		bool publish(const std::string& topic, const std::string& content);
+		uint64_t get_seqno();
+		void reset_seqno();
+	};
+
+	// Applies io thread settings to a zmq context (before its first socket is created). settings the process is not allowed to apply
+	// are skipped with a warning (ZeroMQ aborts when it fails to apply them on its own threads).
+	void set_context_options(zmq::context_t& context, const PerformanceOptions& options);
+
+	// returns true if this process may give threads the SCHED_FIFO priority (probed on a short-lived thread)
+	bool can_set_realtime_priority(int priority);
+
+	// returns true if cpu exists and this process is allowed to run on it
+	bool is_usable_cpu(int cpu);
+
+	// Pins a thread to a CPU and sets its scheduling priority (return false if the OS refused, e.g., due to missing privileges)
+	bool set_thread_affinity(std::thread& thread, int cpu);
+	bool set_thread_priority(std::thread& thread, int priority);
+
+	// inproc endpoints are released asynchronously after their socket closes, so each listener uses its own control endpoint name
+	inline std::string construct_control_endpoint(int port, uint64_t instance) {
+		return "inproc://gab-listener-control-" + std::to_string(port) + "-" + std::to_string(instance);
+	}
+
+	// binds socket, retrying briefly while a recently closed socket still holds the address (zmq closes sockets asynchronously)
+	void bind_socket(zmq::socket_t& socket, const std::string& endpoint);
+};
@@ -3,6 +3,7 @@
 #include <locale>
 #include <codecvt>
 #include <string.h>
+#include <vector>
 
 // "JSON for Modern C++" (see https://github.com/nlohmann/json)
 #include <nlohmann/json.hpp>
@@ -12,6 +13,8 @@
 
 // GodotAiBridge includes
 #include "share.h"
+#include "value.h"
+#include "codec.h"
 
 namespace gab {
 
@@ -71,41 +74,42 @@ namespace gab {
 		return v.get_type() == godot::Variant::DICTIONARY;
 	}
 
-	void marshal_basic_variant(const godot::Variant& value, nlohmann::json& marshaler);
-	void marshal_basic_variant_in_array(const godot::Variant& value, nlohmann::json& marshaler);
-
-	void marshal_array_variant(const godot::Array& dict, nlohmann::json& marshaler);
-	void marshal_dictionary_variant(const godot::Dictionary& dict, nlohmann::json& marshaler);
-
-	void marshal_pool_variant(const godot::Variant& array, nlohmann::json& marshaler);
+	/* VariantValue Class
+	*
+	*  Description: Adapts a godot::Variant to the core Value interface (used to marshal Godot state). Pool int/real/byte arrays are
+	*               reported in bulk through a single read lock. Elements of unsupported types are skipped inside arrays and rejected
+	*               elsewhere.
+	*****************************************************************************************************************************************/
+	class VariantValue : public Value {
+	private:
+		const godot::Variant& value;
+
+	public:
+		explicit VariantValue(const godot::Variant& value);
+
+		void accept(ValueVisitor& visitor) const override;
+	};
+
+	/* VariantBuilder Class
+	*
+	*  Description: A ValueVisitor that builds a godot::Variant (used to unmarshal requests). Typed arrays become PoolIntArray,
+	*               PoolRealArray or PoolByteArray, each filled through a single presized write. Arrays and dictionaries are assembled by
+	*               ContainerBuilder.
+	*****************************************************************************************************************************************/
+	class VariantBuilder : public ContainerBuilder<godot::Variant, godot::Array, godot::Dictionary, godot::String> {
+	public:
+		void visit_nil() override;
+		void visit_bool(bool v) override;
+		void visit_int(int64_t v) override;
+		void visit_real(double v) override;
+		void visit_string(const std::string& v) override;
+
+		void visit_int_array(const int32_t* p_elements, size_t size) override;
+		void visit_real_array(const float* p_elements, size_t size) override;
+		void visit_byte_array(const uint8_t* p_elements, size_t size) override;
+	};
 
 	void marshal_variant(const godot::Variant& value, nlohmann::json& marshaler);
 
-	godot::Variant unmarshal_to_basic_variant(nlohmann::json& value);
-	godot::Variant unmarshal_to_structured_variant(nlohmann::json& value);
-
-	inline godot::Variant unmarshal_to_string_variant(nlohmann::json& value) {
-		return godot::Variant(std::string(value).c_str());
-	}
-
-	inline godot::Variant unmarshal_to_int_variant(nlohmann::json& value) {
-		return godot::Variant(uint64_t(value));
-	}
-
-	inline godot::Variant unmarshal_to_real_variant(nlohmann::json& value) {
-		return godot::Variant(double(value));
-	}
-
-	inline godot::Variant unmarshal_to_bool_variant(nlohmann::json& value) {
-		return godot::Variant(bool(value));
-	}
-
-	inline godot::Variant unmarshal_to_nil_variant(nlohmann::json& value) {
-		return godot::Variant(0);
-	}
-
-	godot::Variant unmarshal_to_variant(nlohmann::json& value);
-	godot::Variant unmarshal_to_array_variant(nlohmann::json& value);
-	godot::Variant unmarshal_to_dictionary_variant(nlohmann::json& value);
-
-};
\ No newline at end of file
+	godot::Variant unmarshal_to_variant(const nlohmann::json& value, ArrayHint hint = ARRAY_HINT_AUTO);
+};
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace gab {
+
+	/* ValueVisitor Class (abstract)
+	*
+	*  Description: Receives the structure of a value one element at a time. Encoders (e.g., JsonWriter) and decoders (e.g., the Godot
+	*               Variant builder) implement this interface, so the marshaling core does not depend on any engine's value types.
+	*               Containers are reported as begin/end pairs; dictionary values are preceded by a call to visit_key. Typed arrays are
+	*               reported in bulk.
+	*****************************************************************************************************************************************/
+	class ValueVisitor {
+	public:
+		virtual ~ValueVisitor() {}
+
+		virtual void visit_nil() = 0;
+		virtual void visit_bool(bool v) = 0;
+		virtual void visit_int(int64_t v) = 0;
+		virtual void visit_real(double v) = 0;
+		virtual void visit_string(const std::string& v) = 0;
+
+		virtual void begin_array(size_t size) = 0;
+		virtual void end_array() = 0;
+
+		virtual void begin_dictionary(size_t size) = 0;
+		virtual void visit_key(const std::string& key) = 0;
+		virtual void end_dictionary() = 0;
+
+		virtual void visit_int_array(const int32_t* p_elements, size_t size) = 0;
+		virtual void visit_real_array(const float* p_elements, size_t size) = 0;
+		virtual void visit_byte_array(const uint8_t* p_elements, size_t size) = 0;
+	};
+
+	/* ContainerBuilder Class Template (abstract)
+	*
+	*  Description: A ValueVisitor that assembles visited arrays and dictionaries into values of type V (e.g., the Godot Variant
+	*               builder). Derived builders convert scalars and typed arrays and pass them to add(). A container is added to its
+	*               parent when it ends, under the key visited before it began, so the keys of a nested dictionary never replace the key
+	*               of its parent. A must support push_back(V), D must support operator[](K) and V must be constructible from A and D.
+	*****************************************************************************************************************************************/
+	template <typename V, typename A, typename D, typename K>
+	class ContainerBuilder : public ValueVisitor {
+	private:
+		V result;
+		std::vector<bool> is_array_open;  // types of the open containers (innermost last)
+		std::vector<A> arrays;  // open arrays (innermost last)
+		std::vector<D> dicts;  // open dictionaries (innermost last)
+		std::vector<K> keys;  // key of the next value of each open dictionary
+
+	protected:
+		void add(const V& v) {
+			if (is_array_open.empty()) {
+				result = v;
+			}
+			else if (is_array_open.back()) {
+				arrays.back().push_back(v);
+			}
+			else {
+				dicts.back()[keys.back()] = v;
+			}
+		}
+
+	public:
+		const V& get_result() const {
+			return result;
+		}
+
+		void begin_array(size_t size) override {
+			is_array_open.push_back(true);
+			arrays.push_back(A());
+		}
+
+		void end_array() override {
+			A array = std::move(arrays.back());
+			arrays.pop_back();
+			is_array_open.pop_back();
+
+			add(V(array));
+		}
+
+		void begin_dictionary(size_t size) override {
+			is_array_open.push_back(false);
+			dicts.push_back(D());
+			keys.push_back(K());
+		}
+
+		void visit_key(const std::string& key) override {
+			keys.back() = K(key.c_str());
+		}
+
+		void end_dictionary() override {
+			D dict = std::move(dicts.back());
+			dicts.pop_back();
+			keys.pop_back();
+			is_array_open.pop_back();
+
+			add(V(dict));
+		}
+	};
+
+	/* Value Class (abstract)
+	*
+	*  Description: A value that can describe itself to a ValueVisitor (e.g., a Godot Variant or a JSON document).
+	*****************************************************************************************************************************************/
+	class Value {
+	public:
+		virtual ~Value() {}
+
+		virtual void accept(ValueVisitor& visitor) const = 0;
+	};
+};
@@ -27,6 +27,9 @@ ACTION_MAP = {'W': 'up',
               'Q': 'rotate_counterclockwise',
               'E': 'rotate_clockwise'}
 
+# user input that requests an episode reset (restores the DEMO environment's initial state)
+RESET_KEY = 'R'
+
 verbose = False
 seqno = 1  # current request's sequence number
 
@@ -40,12 +43,20 @@ def parse_args():
 
     parser.add_argument('--id', type=int, required=False, default=DEFAULT_AGENT,
                         help=f'the id of the agent to which this action will be sent (default: {DEFAULT_AGENT})')
+    parser.add_argument('--ids', type=int, nargs='+', required=False, default=None,
+                        help='the ids of several agents that receive each action in a single batched request')
     parser.add_argument('--host', type=str, required=False, default=DEFAULT_HOST,
                         help=f'the IP address of host running the GAB action listener (default: {DEFAULT_HOST})')
     parser.add_argument('--port', type=int, required=False, default=DEFAULT_PORT,
                         help=f'the port number of the GAB action listener (default: {DEFAULT_PORT})')
     parser.add_argument('--verbose', required=False, action="store_true",
                         help='increases verbosity (displays requests & replies)')
+    parser.add_argument('--query', type=str, required=False, default=None,
+                        help='prints the latest message published on this topic and exits (e.g., /demo/agent/1)')
+    parser.add_argument('--credit', type=int, required=False, default=None,
+                        help='grants this many publication credits (credit-based flow control) and exits')
+    parser.add_argument('--credit-topic', type=str, required=False, default=None,
+                        help='restricts the credit granted by --credit to a single topic (default: usable by any topic)')
 
     return parser.parse_args()
 
@@ -87,11 +98,34 @@ def create_request(data):
     return {'header': header, 'data': data}
 
 
+def create_batch_request(events):
+    """ Creates a single request carrying many events. GAB replies once, with a status for each event.
+
+    :param events: a list of event dictionaries (e.g., one action per agent)
+    :return: the batch request
+    """
+    return create_request(data={'events': events})
+
+
 if __name__ == '__main__':
     try:
         args = parse_args()
         connection = connect(host=args.host, port=args.port)
 
+        # state query: answered by GAB's listener from the most recently published message on the topic
+        if args.query is not None:
+            print(send(connection, create_request(data={'query': args.query})))
+            sys.exit(0)
+
+        # credit grant: allows GAB to publish more messages when credit-based flow control is enabled
+        if args.credit is not None:
+            data = {'credit': args.credit}
+            if args.credit_topic is not None:
+                data['topic'] = args.credit_topic
+
+            print(send(connection, create_request(data=data)))
+            sys.exit(0)
+
         # a global action counter (included in request payload)
         action_id = 0
         agent_id = args.id
@@ -99,11 +133,16 @@ if __name__ == '__main__':
         # MAIN LOOP: receive action via CLI, and send it to GAB action listener
         print('Select an action ID followed by [ENTER]. (All others quit.)')
         while True:
-            action = input('>> A, W, S, D, Q, or E?  ').upper()
-            if action not in ACTION_MAP:
+            action = input('>> A, W, S, D, Q, E, or R (reset)?  ').upper()
+            if action == RESET_KEY:
+                request = create_request(data={'event': {'type': 'reset'}})
+            elif action not in ACTION_MAP:
                 break
-
-            request = create_request(data={'event':{'type':'action', 'agent': args.id, 'value':ACTION_MAP[action]}})
+            elif args.ids:
+                request = create_batch_request([{'type': 'action', 'agent': batch_id, 'value': ACTION_MAP[action]}
+                                                for batch_id in args.ids])
+            else:
+                request = create_request(data={'event':{'type':'action', 'agent': args.id, 'value':ACTION_MAP[action]}})
             reply = send(connection, request)
 
             if args.verbose:
@@ -0,0 +1,104 @@
+#
+# Godot AI Bridge (GAB) - Action Latency Benchmark.
+#
+# Description: Measures round-trip latency of action requests to a running GAB environment (e.g., the DEMO) and reports percentiles.
+#              Compare runs with different "performance" connect options (busy_poll_us, listener_cpu, io_threads, ...).
+# Dependencies: PyZMQ (see https://pyzmq.readthedocs.io/en/latest/)
+#
+
+import argparse
+import json
+import sys
+import os
+import time
+
+import zmq  # Python Bindings for ZeroMq (PyZMQ)
+
+DEFAULT_TIMEOUT = 5000  # in milliseconds
+
+DEFAULT_HOST = 'localhost'
+DEFAULT_PORT = 10002
+DEFAULT_REQUESTS = 10000
+DEFAULT_WARMUP = 500
+DEFAULT_INTERVAL = 0.0  # in seconds
+
+
+def parse_args():
+    """ Parses command line arguments. """
+    parser = argparse.ArgumentParser(description='Godot AI Bridge (GAB) - Action Latency Benchmark')
+
+    parser.add_argument('--host', type=str, required=False, default=DEFAULT_HOST,
+                        help=f'the IP address of host running the GAB action listener (default: {DEFAULT_HOST})')
+    parser.add_argument('--port', type=int, required=False, default=DEFAULT_PORT,
+                        help=f'the port number of the GAB action listener (default: {DEFAULT_PORT})')
+    parser.add_argument('--requests', type=int, required=False, default=DEFAULT_REQUESTS,
+                        help=f'the number of timed requests (default: {DEFAULT_REQUESTS})')
+    parser.add_argument('--warmup', type=int, required=False, default=DEFAULT_WARMUP,
+                        help=f'the number of untimed requests sent first (default: {DEFAULT_WARMUP})')
+    parser.add_argument('--interval', type=float, required=False, default=DEFAULT_INTERVAL,
+                        help=f'seconds to pause between requests, which simulates a training step (default: {DEFAULT_INTERVAL})')
+    parser.add_argument('--query', type=str, required=False, default=None,
+                        help='times state queries for this topic instead of actions (e.g., /demo/agent/1)')
+
+    return parser.parse_args()
+
+
+def connect(host=DEFAULT_HOST, port=DEFAULT_PORT):
+    """ Establishes a connection to Godot AI Bridge action listener.
+
+    :param host: the GAB action listener's host IP address
+    :param port: the GAB action listener's port number
+    :return: socket connection
+    """
+    socket = zmq.Context().socket(zmq.REQ)
+    socket.connect(f'tcp://{host}:{str(port)}')
+
+    # without timeout the process can hang indefinitely
+    socket.setsockopt(zmq.RCVTIMEO, DEFAULT_TIMEOUT)
+    return socket
+
+
+def percentile(sorted_values, p):
+    """ Returns the p-th percentile (nearest rank) of an ascending list of values. """
+    ndx = max(0, min(len(sorted_values) - 1, round(p / 100.0 * len(sorted_values)) - 1))
+    return sorted_values[ndx]
+
+
+if __name__ == '__main__':
+    try:
+        args = parse_args()
+        connection = connect(host=args.host, port=args.port)
+
+        if args.query is not None:
+            data = {'query': args.query}
+        else:
+            # an unrecognized action value leaves the DEMO environment unchanged
+            data = {'event': {'type': 'action', 'agent': 1, 'value': 'noop'}}
+
+        latencies = []
+        for seqno in range(1, args.warmup + args.requests + 1):
+            request = json.dumps({'header': {'seqno': seqno, 'time': round(time.time() * 1000)}, 'data': data})
+
+            start = time.perf_counter()
+            connection.send_string(request)
+            connection.recv()
+            elapsed = time.perf_counter() - start
+
+            if seqno > args.warmup:
+                latencies.append(elapsed * 1e6)
+
+            if args.interval > 0:
+                time.sleep(args.interval)
+
+        latencies.sort()
+        print(f'requests: {len(latencies)}')
+        for p in (50, 90, 99, 99.9):
+            print(f'p{p}: {percentile(latencies, p):.1f} us')
+        print(f'max: {latencies[-1]:.1f} us')
+
+    except KeyboardInterrupt:
+
+        try:
+            sys.exit(1)
+        except SystemExit:
+            os._exit(1)
@@ -9,6 +9,7 @@ import json
 import argparse
 import sys
 import os
+import time
 
 import zmq  # Python Bindings for ZeroMq (PyZMQ)
 
@@ -16,6 +17,7 @@ DEFAULT_TIMEOUT = 5000  # in milliseconds
 
 DEFAULT_HOST = 'localhost'
 DEFAULT_PORT = 10001
+DEFAULT_LISTENER_PORT = 10002
 
 # by default, receives all published messages (i.e., all topics accepted)
 MSG_TOPIC_FILTER = ''
@@ -29,6 +31,11 @@ def parse_args():
                         help=f'the IP address of host running the GAB state publisher (default: {DEFAULT_HOST})')
     parser.add_argument('--port', type=int, required=False, default=DEFAULT_PORT,
                         help=f'the port number of the GAB state publisher (default: {DEFAULT_PORT})')
+    parser.add_argument('--credit', type=int, required=False, default=0,
+                        help='for environments using credit-based flow control: the number of messages this subscriber '
+                             'allows in flight (one credit is returned to GAB for each message received)')
+    parser.add_argument('--listener-port', type=int, required=False, default=DEFAULT_LISTENER_PORT,
+                        help=f'the port number of the GAB action listener, used to grant credit (default: {DEFAULT_LISTENER_PORT})')
 
     return parser.parse_args()
 
@@ -51,6 +58,36 @@ def connect(host=DEFAULT_HOST, port=DEFAULT_PORT):
     return socket
 
 
+def connect_listener(host=DEFAULT_HOST, port=DEFAULT_LISTENER_PORT):
+    """ Establishes a connection to Godot AI Bridge action listener (used to grant credit).
+
+    :param host: the GAB action listener's host IP address
+    :param port: the GAB action listener's port number
+    :return: socket connection
+    """
+    socket = zmq.Context().socket(zmq.REQ)
+    socket.setsockopt(zmq.RCVTIMEO, DEFAULT_TIMEOUT)
+
+    socket.connect(f'tcp://{host}:{str(port)}')
+    return socket
+
+
+def grant_credit(connection, n, topic=None):
+    """ Allows GAB to publish n more messages (on topic, or on any topic if None).
+
+    :param connection: a connection to the GAB action listener
+    :param n: the number of credits granted
+    :param topic: the topic that may use the credit (None for all topics)
+    :return: GAB action listener's reply (includes the credit now available)
+    """
+    data = {'credit': n}
+    if topic is not None:
+        data['topic'] = topic
+
+    connection.send_json({'header': {'time': round(time.time() * 1000)}, 'data': data})
+    return connection.recv_json()
+
+
 def receive(connection):
     """ Receives and decodes next message from the GAB state publisher, waiting until TIMEOUT reached in none available.
 
@@ -60,9 +97,8 @@ def receive(connection):
     msg = connection.recv_string()
 
     # messages are received as strings of the form: "<TOPIC> <JSON>". this splits the message string into TOPIC
-    # and JSON-encoded payload
-    ndx = msg.find('{')
-    topic, encoded_payload = msg[0:ndx - 1], msg[ndx:]
+    # and JSON-encoded payload (topics never contain spaces)
+    topic, _, encoded_payload = msg.partition(' ')
 
     # unmarshal JSON message content
     payload = json.loads(encoded_payload)
@@ -75,10 +111,19 @@ if __name__ == "__main__":
         args = parse_args()
         connection = connect(host=args.host, port=args.port)
 
+        # credit-based flow control: GAB publishes at most args.credit messages ahead of this subscriber
+        listener = None
+        if args.credit > 0:
+            listener = connect_listener(host=args.host, port=args.listener_port)
+            print(grant_credit(listener, args.credit), flush=True)
+
         while True:
             topic, payload = receive(connection)
             print(f'topic: {topic}; payload: {payload}', flush=True)
 
+            if listener is not None:
+                grant_credit(listener, 1)
+
     except KeyboardInterrupt:
 
         try:
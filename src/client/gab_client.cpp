@@ -0,0 +1,313 @@
+#include "gab_client.h"
+
+using namespace std;
+using namespace gab;
+
+static const int CLIENT_LINGER = 0;  // pending messages discarded immediately on socket close
+
+// returns false if no message arrived on socket within timeout (in milliseconds)
+static bool wait_for_message(zmq::socket_t& socket, int timeout)
+{
+	zmq_pollitem_t items[] = { { static_cast<void*>(socket), 0, ZMQ_POLLIN, 0 } };
+
+	int n_ready = zmq_poll(items, 1, timeout);
+	if (n_ready < 0) {
+		throw GodotAiBridgeException(std::string("poll failed -> ") + zmq_strerror(zmq_errno()));
+	}
+
+	return n_ready > 0;
+}
+
+static json construct_request(uint64_t seqno, const json& data)
+{
+	json request;
+	construct_message_header(request[MSG_HEADER], seqno, 0);
+	request[MSG_DATA] = data;
+
+	return request;
+}
+
+// data element of a credit grant (an empty topic grants credit usable by any topic)
+static json create_credit_data(int64_t n, const std::string& topic)
+{
+	json data = { {CREDIT, n} };
+	if (!topic.empty()) {
+		data[CREDIT_TOPIC] = topic;
+	}
+
+	return data;
+}
+
+/* Implementation of StateMessage Class
+ ***************************************/
+StateMessage::StateMessage()
+	: n_frames(0)
+{
+
+}
+
+std::string_view StateMessage::get_topic() const
+{
+	return topic;
+}
+
+std::string_view StateMessage::get_payload() const
+{
+	return payload;
+}
+
+json StateMessage::parse() const
+{
+	return json::parse(payload.begin(), payload.end());
+}
+
+size_t StateMessage::get_frame_count() const
+{
+	return n_frames;
+}
+
+const zmq::message_t& StateMessage::get_frame(size_t ndx) const
+{
+	if (ndx >= n_frames) {
+		throw GodotAiBridgeException("frame index out of range: " + std::to_string(ndx));
+	}
+
+	return frames[ndx];
+}
+
+
+/* Implementation of StateSubscriber Class
+ ******************************************/
+StateSubscriber::StateSubscriber(zmq::context_t& zmq_context, const std::string& host, int port)
+	: socket(zmq_context, ZMQ_SUB)
+{
+	set_options(socket, { {ZMQ_LINGER, CLIENT_LINGER} });
+	socket.connect(construct_endpoint(host, port));
+}
+
+void StateSubscriber::subscribe(const std::string& topic_prefix)
+{
+	socket.setsockopt(ZMQ_SUBSCRIBE, topic_prefix.c_str(), topic_prefix.length());
+}
+
+void StateSubscriber::unsubscribe(const std::string& topic_prefix)
+{
+	socket.setsockopt(ZMQ_UNSUBSCRIBE, topic_prefix.c_str(), topic_prefix.length());
+}
+
+bool StateSubscriber::receive(StateMessage& message_out, int timeout)
+{
+	if (!wait_for_message(socket, timeout)) {
+		return false;
+	}
+
+	// receive all frames of the message (frame objects are reused across calls)
+	message_out.n_frames = 0;
+	do {
+		if (message_out.n_frames == message_out.frames.size()) {
+			message_out.frames.emplace_back();
+		}
+
+		if (!socket.recv(message_out.frames[message_out.n_frames], zmq::recv_flags::dontwait)) {
+			throw GodotAiBridgeException("incomplete message received");
+		}
+	} while (message_out.frames[message_out.n_frames++].more());
+
+	split_topic_message(message_out.frames[0], message_out.topic, message_out.payload);
+	return true;
+}
+
+
+/* Implementation of ActionSender Class
+ ***************************************/
+ActionSender::ActionSender(zmq::context_t& zmq_context, const std::string& host, int port, size_t max_in_flight)
+	: socket(zmq_context, ZMQ_DEALER),
+	  seqno(1),
+	  max_in_flight(std::max<size_t>(max_in_flight, 1))
+{
+	set_options(socket, { {ZMQ_LINGER, CLIENT_LINGER} });
+	socket.connect(construct_endpoint(host, port));
+}
+
+uint64_t ActionSender::send(const json& data, int timeout)
+{
+	// wait for room in the pipeline (replies that arrive meanwhile are kept for receive)
+	while (in_flight.size() >= max_in_flight) {
+		collect_reply(timeout);
+	}
+
+	uint64_t request_seqno = seqno++;
+
+	// the listener is a REP socket, which expects requests to start with an empty delimiter frame
+	zmq::message_t delimiter;
+	zmq::message_t request_message = construct_message(construct_request(request_seqno, data).dump());
+
+	socket.send(delimiter, zmq::send_flags::sndmore);
+	socket.send(request_message, zmq::send_flags::none);
+
+	in_flight.push_back(request_seqno);
+	return request_seqno;
+}
+
+uint64_t ActionSender::send_event(const json& event, int timeout)
+{
+	return send(json{ {EVENT, event} }, timeout);
+}
+
+uint64_t ActionSender::send_events(const json& events, int timeout)
+{
+	return send(json{ {EVENTS, events} }, timeout);
+}
+
+uint64_t ActionSender::send_query(const std::string& topic, int timeout)
+{
+	return send(json{ {QUERY, topic} }, timeout);
+}
+
+uint64_t ActionSender::send_credit(int64_t n, const std::string& topic, int timeout)
+{
+	return send(create_credit_data(n, topic), timeout);
+}
+
+bool ActionSender::receive(json& reply_out, uint64_t& seqno_out, int timeout)
+{
+	if (!received.empty()) {
+		seqno_out = received.front().first;
+		reply_out = std::move(received.front().second);
+		received.pop_front();
+
+		return true;
+	}
+
+	return receive_from_socket(reply_out, seqno_out, timeout);
+}
+
+bool ActionSender::receive_from_socket(json& reply_out, uint64_t& seqno_out, int timeout)
+{
+	if (in_flight.empty()) {
+		throw GodotAiBridgeException("no requests awaiting replies");
+	}
+
+	if (!wait_for_message(socket, timeout)) {
+		return false;
+	}
+
+	// a reply has arrived for the oldest request, so it is no longer in flight (even if the reply turns out to be malformed)
+	seqno_out = in_flight.front();
+	in_flight.pop_front();
+
+	// replies arrive as an empty delimiter frame followed by the JSON-encoded reply
+	zmq::message_t delimiter;
+	zmq::message_t reply;
+
+	if (!socket.recv(delimiter, zmq::recv_flags::dontwait) || !delimiter.more() || !socket.recv(reply, zmq::recv_flags::none)) {
+		throw GodotAiBridgeException("malformed reply received (seqno: " + std::to_string(seqno_out) + ")");
+	}
+
+	try {
+		const char* p_begin = static_cast<const char*>(reply.data());
+		reply_out = json::parse(p_begin, p_begin + reply.size());
+	}
+	catch (const json::parse_error& e) {
+		throw GodotAiBridgeException("malformed reply received (seqno: " + std::to_string(seqno_out) + ") -> " + e.what());
+	}
+
+	return true;
+}
+
+void ActionSender::collect_reply(int timeout)
+{
+	json reply;
+	uint64_t reply_seqno;
+
+	if (!receive_from_socket(reply, reply_seqno, timeout)) {
+		throw GodotAiBridgeException("timed out waiting for reply (seqno: " + std::to_string(in_flight.front()) + ")");
+	}
+
+	received.emplace_back(reply_seqno, std::move(reply));
+}
+
+json ActionSender::request(const json& data, int timeout)
+{
+	flush(timeout);
+
+	send(data, timeout);
+
+	// the replies of older requests stay queued for receive, so this request's reply is read directly
+	json reply;
+	uint64_t reply_seqno;
+	if (!receive_from_socket(reply, reply_seqno, timeout)) {
+		throw GodotAiBridgeException("timed out waiting for reply (seqno: " + std::to_string(in_flight.front()) + ")");
+	}
+
+	return reply;
+}
+
+size_t ActionSender::get_in_flight() const
+{
+	return in_flight.size();
+}
+
+size_t ActionSender::get_received() const
+{
+	return received.size();
+}
+
+void ActionSender::flush(int timeout)
+{
+	while (!in_flight.empty()) {
+		collect_reply(timeout);
+	}
+}
+
+void ActionSender::discard_received()
+{
+	received.clear();
+}
+
+
+/* Implementation of VectorEnv Class
+ ************************************/
+VectorEnv::VectorEnv(const std::vector<std::string>& topics, const std::string& host, int publisher_port, int listener_port)
+	: zmq_context(),
+	  subscriber(zmq_context, host, publisher_port),
+	  sender(zmq_context, host, listener_port)
+{
+	for (const std::string& topic : topics) {
+		subscriber.subscribe(topic);
+	}
+}
+
+json VectorEnv::step(const std::vector<json>& events, int timeout)
+{
+	return sender.request(json{ {EVENTS, events} }, timeout);
+}
+
+size_t VectorEnv::poll(int timeout)
+{
+	size_t n_received = 0;
+
+	// only the first receive waits; afterwards, messages that are already queued are drained
+	while (subscriber.receive(message, (n_received == 0) ? timeout : 0)) {
+		observations[std::string(message.get_topic())] = message.parse();
+		n_received++;
+	}
+
+	return n_received;
+}
+
+const json* VectorEnv::get_observation(const std::string& topic) const
+{
+	auto search = observations.find(topic);
+	return (search != observations.end()) ? &search->second : nullptr;
+}
+
+json VectorEnv::query(const std::string& topic, int timeout)
+{
+	return sender.request(json{ {QUERY, topic} }, timeout);
+}
+
+json VectorEnv::grant_credit(int64_t n, const std::string& topic, int timeout)
+{
+	return sender.request(create_credit_data(n, topic), timeout);
+}
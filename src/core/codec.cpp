@@ -0,0 +1,411 @@
+#include "codec.h"
+
+using namespace std;
+using namespace gab;
+
+using json = nlohmann::json;
+
+gab::ArrayHint gab::convert_array_hint(const std::string& v) {
+	static const std::map<std::string, ArrayHint> ARRAY_HINT_MAP = {
+		{"auto", ARRAY_HINT_AUTO},
+		{"generic", ARRAY_HINT_GENERIC},
+		{"int", ARRAY_HINT_INT},
+		{"real", ARRAY_HINT_REAL},
+		{"byte", ARRAY_HINT_BYTE},
+	};
+
+	auto search = ARRAY_HINT_MAP.find(v);
+	if (search == ARRAY_HINT_MAP.end()) {
+		throw GodotAiBridgeException("unrecognized array hint: " + v);
+	}
+
+	return search->second;
+}
+
+gab::ArrayHint gab::get_array_hint(const json& request)
+{
+	if (request.is_object() && request.contains(MSG_HEADER)) {
+		const json& header = request[MSG_HEADER];
+
+		if (header.is_object() && header.contains(ARRAY_HINT)) {
+			if (!header[ARRAY_HINT].is_string()) {
+				throw GodotAiBridgeException("array hint must be a string");
+			}
+
+			return convert_array_hint(header[ARRAY_HINT].get<std::string>());
+		}
+	}
+
+	return ARRAY_HINT_AUTO;
+}
+
+bool gab::is_float_representable(double v)
+{
+	if (!(std::fabs(v) <= double(std::numeric_limits<float>::max()))) {
+		return false;
+	}
+
+	// exactly representable (e.g., integers up to 2^24 and dyadic fractions)
+	float f = float(v);
+	if (double(f) == v) {
+		return true;
+	}
+
+	// otherwise the float must still read back as the same decimal number (e.g., 0.1), within float's 7 significant digits
+	char buffer[32];
+	snprintf(buffer, sizeof(buffer), "%.*g", std::numeric_limits<float>::digits10 + 1, double(f));
+
+	return std::strtod(buffer, nullptr) == v;
+}
+
+gab::NumericArrayType gab::get_numeric_array_type(const json& value) {
+	static const int64_t INT_MIN_VALUE = std::numeric_limits<int32_t>::min();
+	static const int64_t INT_MAX_VALUE = std::numeric_limits<int32_t>::max();
+
+	// empty arrays carry no element type information
+	if (value.empty()) {
+		return NUMERIC_ARRAY_NONE;
+	}
+
+	NumericArrayType type = NUMERIC_ARRAY_INT;
+	bool is_float_array = true;  // all elements survive conversion to the 32-bit floats of typed real arrays
+
+	for (json::const_iterator it = value.begin(); it != value.end(); ++it) {
+		if (it->is_number_float()) {
+			type = NUMERIC_ARRAY_REAL;
+			is_float_array = is_float_array && is_float_representable(it->get<double>());
+		}
+		else if (it->is_number_unsigned()) {
+			if (it->get<uint64_t>() > uint64_t(INT_MAX_VALUE)) {
+				return NUMERIC_ARRAY_NONE;  // typed int array elements are 32-bit
+			}
+			is_float_array = is_float_array && is_float_representable(double(it->get<uint64_t>()));
+		}
+		else if (it->is_number_integer()) {
+			int64_t element = it->get<int64_t>();
+			if (element < INT_MIN_VALUE || element > INT_MAX_VALUE) {
+				return NUMERIC_ARRAY_NONE;  // typed int array elements are 32-bit
+			}
+			is_float_array = is_float_array && is_float_representable(double(element));
+		}
+		else {
+			return NUMERIC_ARRAY_NONE;
+		}
+	}
+
+	// reals that a float would alter (e.g., 123456789 next to 0.5) keep the generic form, which preserves doubles
+	if (type == NUMERIC_ARRAY_REAL && !is_float_array) {
+		return NUMERIC_ARRAY_NONE;
+	}
+
+	return type;
+}
+
+// returns an element of a forced int/byte array. elements that are not integral or do not fit the array's element type are
+// rejected (rather than silently truncated or wrapped).
+static int64_t get_integral_element(const json& element, int64_t min_value, int64_t max_value, const char* array_type)
+{
+	bool is_in_range = false;
+	int64_t v = 0;
+
+	if (element.is_number_float()) {
+		double d = element.get<double>();
+		if (d != std::trunc(d)) {
+			throw GodotAiBridgeException(std::string("unmarshal failed (reason: ") + array_type + " array element is not integral). value = " + element.dump());
+		}
+
+		is_in_range = d >= double(min_value) && d <= double(max_value);
+		v = is_in_range ? int64_t(d) : 0;
+	}
+	else if (element.is_number_unsigned()) {
+		uint64_t u = element.get<uint64_t>();
+		is_in_range = u <= uint64_t(max_value);
+		v = is_in_range ? int64_t(u) : 0;
+	}
+	else {
+		v = element.get<int64_t>();
+		is_in_range = v >= min_value && v <= max_value;
+	}
+
+	if (!is_in_range) {
+		throw GodotAiBridgeException(std::string("unmarshal failed (reason: ") + array_type + " array element out of range). value = " + element.dump());
+	}
+
+	return v;
+}
+
+// the typed array decoders convert elements into a per-thread scratch buffer that is reported to the visitor in bulk
+static void decode_int_array(const json& value, ValueVisitor& visitor)
+{
+	static const int64_t INT_MIN_VALUE = std::numeric_limits<int32_t>::min();
+	static const int64_t INT_MAX_VALUE = std::numeric_limits<int32_t>::max();
+
+	thread_local std::vector<int32_t> elements;
+	elements.resize(value.size());
+
+	int32_t* p_element = elements.data();
+	for (json::const_iterator it = value.begin(); it != value.end(); ++it) {
+		*p_element++ = int32_t(get_integral_element(*it, INT_MIN_VALUE, INT_MAX_VALUE, "int"));
+	}
+
+	visitor.visit_int_array(elements.data(), elements.size());
+}
+
+static void decode_real_array(const json& value, ValueVisitor& visitor)
+{
+	thread_local std::vector<float> elements;
+	elements.resize(value.size());
+
+	// forced real arrays accept the loss of precision, but not values beyond the range of float
+	float* p_element = elements.data();
+	for (json::const_iterator it = value.begin(); it != value.end(); ++it) {
+		double d = it->get<double>();
+		if (!(std::fabs(d) <= double(std::numeric_limits<float>::max()))) {
+			throw GodotAiBridgeException("unmarshal failed (reason: real array element out of range). value = " + it->dump());
+		}
+
+		*p_element++ = float(d);
+	}
+
+	visitor.visit_real_array(elements.data(), elements.size());
+}
+
+static void decode_byte_array(const json& value, ValueVisitor& visitor)
+{
+	thread_local std::vector<uint8_t> elements;
+	elements.resize(value.size());
+
+	uint8_t* p_element = elements.data();
+	for (json::const_iterator it = value.begin(); it != value.end(); ++it) {
+		*p_element++ = uint8_t(get_integral_element(*it, 0, 255, "byte"));
+	}
+
+	visitor.visit_byte_array(elements.data(), elements.size());
+}
+
+static void decode_array(const json& value, ValueVisitor& visitor, ArrayHint hint)
+{
+	if (hint != ARRAY_HINT_GENERIC) {
+		NumericArrayType type = get_numeric_array_type(value);
+
+		// typed arrays are only forced onto numeric arrays. arrays of ints that overflow 32-bits are still numeric (forced int and byte
+		// arrays then reject the elements that do not fit).
+		if (type == NUMERIC_ARRAY_NONE && !value.empty() && hint != ARRAY_HINT_AUTO) {
+			bool is_numeric = std::all_of(value.begin(), value.end(), [](const json& e) { return e.is_number(); });
+			type = is_numeric ? NUMERIC_ARRAY_REAL : NUMERIC_ARRAY_NONE;
+		}
+
+		if (type != NUMERIC_ARRAY_NONE) {
+			switch (hint) {
+			case ARRAY_HINT_INT:
+				decode_int_array(value, visitor);
+				break;
+			case ARRAY_HINT_REAL:
+				decode_real_array(value, visitor);
+				break;
+			case ARRAY_HINT_BYTE:
+				decode_byte_array(value, visitor);
+				break;
+			default:
+				(type == NUMERIC_ARRAY_INT) ? decode_int_array(value, visitor) : decode_real_array(value, visitor);
+			}
+			return;
+		}
+	}
+
+	visitor.begin_array(value.size());
+	for (json::const_iterator it = value.begin(); it != value.end(); ++it) {
+		decode_json(*it, visitor, hint);
+	}
+	visitor.end_array();
+}
+
+void gab::decode_json(const json& value, ValueVisitor& visitor, ArrayHint hint)
+{
+	switch (value.type()) {
+	case json::value_t::null:
+		visitor.visit_nil();
+		break;
+	case json::value_t::boolean:
+		visitor.visit_bool(value.get<bool>());
+		break;
+	case json::value_t::number_integer:
+		visitor.visit_int(value.get<int64_t>());
+		break;
+	case json::value_t::number_unsigned:
+		// integers beyond the range of int64_t become reals (rather than wrapping to negative values)
+		if (value.get<uint64_t>() > uint64_t(std::numeric_limits<int64_t>::max())) {
+			visitor.visit_real(double(value.get<uint64_t>()));
+		}
+		else {
+			visitor.visit_int(value.get<int64_t>());
+		}
+		break;
+	case json::value_t::number_float:
+		visitor.visit_real(value.get<double>());
+		break;
+	case json::value_t::string:
+		visitor.visit_string(value.get_ref<const std::string&>());
+		break;
+	case json::value_t::binary:
+	{
+		const json::binary_t& binary = value.get_binary();
+		visitor.visit_byte_array(binary.data(), binary.size());
+		break;
+	}
+	case json::value_t::array:
+		decode_array(value, visitor, hint);
+		break;
+	case json::value_t::object:
+	{
+		visitor.begin_dictionary(value.size());
+		for (json::const_iterator it = value.begin(); it != value.end(); ++it) {
+			visitor.visit_key(it.key());
+			decode_json(it.value(), visitor, hint);
+		}
+		visitor.end_dictionary();
+		break;
+	}
+	default:
+		throw GodotAiBridgeException("unmarshal failed (reason: unknown value type). value = " + value.dump());
+	}
+}
+
+void gab::encode_value(const Value& value, json& marshaler)
+{
+	JsonWriter writer(marshaler);
+	value.accept(writer);
+}
+
+
+/* Implementation of JsonWriter Class
+ *************************************/
+JsonWriter::JsonWriter(json& marshaler)
+	: root(marshaler)
+{
+
+}
+
+json& JsonWriter::next_element()
+{
+	if (containers.empty()) {
+		return root;
+	}
+
+	json& container = *containers.back();
+	if (container.is_array()) {
+		container.push_back(nullptr);
+		return container.back();
+	}
+
+	return container[key];
+}
+
+void JsonWriter::visit_nil()
+{
+	next_element() = nullptr;
+}
+
+void JsonWriter::visit_bool(bool v)
+{
+	next_element() = v;
+}
+
+void JsonWriter::visit_int(int64_t v)
+{
+	next_element() = v;
+}
+
+void JsonWriter::visit_real(double v)
+{
+	next_element() = v;
+}
+
+void JsonWriter::visit_string(const std::string& v)
+{
+	next_element() = v;
+}
+
+void JsonWriter::begin_array(size_t size)
+{
+	json& element = next_element();
+	element = json::array();
+	element.get_ref<json::array_t&>().reserve(size);
+
+	// elements are only appended to the innermost container, so this pointer stays valid until end_array
+	containers.push_back(&element);
+}
+
+void JsonWriter::end_array()
+{
+	containers.pop_back();
+}
+
+void JsonWriter::begin_dictionary(size_t size)
+{
+	json& element = next_element();
+	element = json::object();
+
+	containers.push_back(&element);
+}
+
+void JsonWriter::visit_key(const std::string& key)
+{
+	this->key = key;
+}
+
+void JsonWriter::end_dictionary()
+{
+	containers.pop_back();
+}
+
+void JsonWriter::visit_int_array(const int32_t* p_elements, size_t size)
+{
+	json& element = next_element();
+	element = json::array();
+
+	json::array_t& elements = element.get_ref<json::array_t&>();
+	elements.reserve(size);
+	for (size_t i = 0; i < size; i++) {
+		elements.emplace_back(p_elements[i]);
+	}
+}
+
+void JsonWriter::visit_real_array(const float* p_elements, size_t size)
+{
+	json& element = next_element();
+	element = json::array();
+
+	json::array_t& elements = element.get_ref<json::array_t&>();
+	elements.reserve(size);
+	for (size_t i = 0; i < size; i++) {
+		elements.emplace_back(double(p_elements[i]));
+	}
+}
+
+void JsonWriter::visit_byte_array(const uint8_t* p_elements, size_t size)
+{
+	json& element = next_element();
+	element = json::array();
+
+	json::array_t& elements = element.get_ref<json::array_t&>();
+	elements.reserve(size);
+	for (size_t i = 0; i < size; i++) {
+		elements.emplace_back(p_elements[i]);
+	}
+}
+
+
+/* Implementation of JsonValue Class
+ ************************************/
+JsonValue::JsonValue(const json& value, ArrayHint hint)
+	: value(value),
+	  hint(hint)
+{
+
+}
+
+void JsonValue::accept(ValueVisitor& visitor) const
+{
+	decode_json(value, visitor, hint);
+}
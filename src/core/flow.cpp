@@ -0,0 +1,197 @@
+#include "flow.h"
+
+using namespace std;
+using namespace gab;
+
+using json = nlohmann::json;
+
+const char* gab::get_publish_status_name(PublishStatus status)
+{
+	switch (status) {
+	case PUBLISH_SENT:
+		return "sent";
+	case PUBLISH_QUEUED:
+		return "queued";
+	case PUBLISH_ERROR:
+		return "error";
+	default:
+		return "dropped";
+	}
+}
+
+/* Implementation of FlowController Class
+ *****************************************/
+FlowController::FlowController()
+	: shared_credit(DEFAULT_INITIAL_CREDIT)
+{
+
+}
+
+void FlowController::configure(const FlowControlOptions& options)
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		this->options = options;
+	}
+
+	clear_credit();
+	clear_held();
+	clear_backpressure();
+}
+
+bool FlowController::is_credit_enabled() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return options.is_credit_enabled;
+}
+
+int64_t FlowController::grant(const std::string& topic, int64_t n)
+{
+	if (n < 0) {
+		throw GodotAiBridgeException("credit must be non-negative");
+	}
+
+	std::lock_guard<std::mutex> lock(mutex);
+
+	if (!options.is_credit_enabled) {
+		throw GodotAiBridgeException("credit-based flow control is not enabled");
+	}
+
+	int64_t& credit = topic.empty() ? shared_credit : topic_credits[topic];
+	credit = std::min(credit + n, options.max_credit);
+
+	return credit;
+}
+
+bool FlowController::has_credit(const std::string& topic) const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	if (!options.is_credit_enabled || shared_credit > 0) {
+		return true;
+	}
+
+	auto search = topic_credits.find(topic);
+	return search != topic_credits.end() && search->second > 0;
+}
+
+bool FlowController::try_acquire(const std::string& topic, CreditSource& source_out)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	source_out = CREDIT_NONE;
+
+	if (!options.is_credit_enabled) {
+		return true;
+	}
+
+	// credit granted to the topic is used before the shared pool
+	auto search = topic_credits.find(topic);
+	if (search != topic_credits.end() && search->second > 0) {
+		search->second--;
+		source_out = CREDIT_TOPIC;
+		return true;
+	}
+
+	if (shared_credit > 0) {
+		shared_credit--;
+		source_out = CREDIT_SHARED;
+		return true;
+	}
+
+	return false;
+}
+
+void FlowController::release(const std::string& topic, CreditSource source)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	// no credit was taken while credit-based flow control is disabled
+	if (!options.is_credit_enabled || source == CREDIT_NONE) {
+		return;
+	}
+
+	int64_t& credit = (source == CREDIT_SHARED) ? shared_credit : topic_credits[topic];
+	credit = std::min(credit + 1, options.max_credit);
+}
+
+void FlowController::clear_credit()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	topic_credits.clear();
+	shared_credit = std::min(options.initial_credit, options.max_credit);
+}
+
+void FlowController::hold(const std::string& topic, json&& message)
+{
+	pending[topic] = std::move(message);
+}
+
+bool FlowController::take_held(const std::string& topic, json& message_out)
+{
+	auto search = pending.find(topic);
+	if (search == pending.end()) {
+		return false;
+	}
+
+	message_out = std::move(search->second);
+	pending.erase(search);
+
+	return true;
+}
+
+void FlowController::discard_held(const std::string& topic)
+{
+	pending.erase(topic);
+}
+
+void FlowController::clear_held()
+{
+	pending.clear();
+}
+
+void FlowController::collect_held_topics(std::vector<std::string>& topics_out) const
+{
+	topics_out.clear();
+	for (const auto& entry : pending) {
+		topics_out.push_back(entry.first);
+	}
+}
+
+BackpressureChange FlowController::record(const std::string& topic, PublishStatus status)
+{
+	int threshold = std::max(options.backpressure_threshold, 1);
+
+	// errors say nothing about whether consumers keep up
+	if (status == PUBLISH_ERROR) {
+		return BACKPRESSURE_UNCHANGED;
+	}
+
+	if (status == PUBLISH_SENT) {
+		auto search = undelivered.find(topic);
+		if (search == undelivered.end()) {
+			return BACKPRESSURE_UNCHANGED;
+		}
+
+		bool was_congested = search->second >= threshold;
+		undelivered.erase(search);
+
+		return was_congested ? BACKPRESSURE_ENDED : BACKPRESSURE_UNCHANGED;
+	}
+
+	// reported once, when the threshold is reached
+	int n_undelivered = ++undelivered[topic];
+	return (n_undelivered == threshold) ? BACKPRESSURE_STARTED : BACKPRESSURE_UNCHANGED;
+}
+
+int FlowController::get_undelivered(const std::string& topic) const
+{
+	auto search = undelivered.find(topic);
+	return (search != undelivered.end()) ? search->second : 0;
+}
+
+void FlowController::clear_backpressure()
+{
+	undelivered.clear();
+}
@@ -0,0 +1,144 @@
+#include "scheduler.h"
+
+using namespace std;
+using namespace gab;
+
+// weight of the newest sample in the moving average of message sizes
+static const double MESSAGE_SIZE_SMOOTHING = 0.2;
+
+// fractional part of the golden ratio (used to spread initial publication times evenly across a topic's interval)
+static const double PHASE_STEP = 0.6180339887498949;
+
+/* Implementation of PublishScheduler Class
+ *******************************************/
+PublishScheduler::PublishScheduler()
+	: bandwidth_limit(DEFAULT_BANDWIDTH_LIMIT),
+	  bandwidth_credit(0.0),
+	  last_refill(-1.0),
+	  max_topics_per_frame(DEFAULT_MAX_TOPICS_PER_FRAME),
+	  n_registrations(0)
+{
+
+}
+
+void PublishScheduler::add_topic(const std::string& name, double rate, int priority, double now)
+{
+	if (!(rate > 0.0)) {
+		throw GodotAiBridgeException("publish rate must be positive (topic: " + name + ")");
+	}
+
+	double interval = 1.0 / rate;
+
+	auto search = topics.find(name);
+	if (search != topics.end()) {
+		Topic& topic = search->second;
+
+		// keep the existing phase, but never wait longer than the new interval
+		topic.next_due = std::min(topic.next_due, now + interval);
+		topic.interval = interval;
+		topic.priority = priority;
+		return;
+	}
+
+	double phase = PHASE_STEP * double(n_registrations++);
+	phase -= double(uint64_t(phase));
+
+	topics[name] = Topic{ name, interval, priority, now + phase * interval, 0.0, 0, 0 };
+}
+
+bool PublishScheduler::remove_topic(const std::string& name)
+{
+	return topics.erase(name) > 0;
+}
+
+void PublishScheduler::set_bandwidth_limit(double bytes_per_second)
+{
+	bandwidth_limit = std::max(bytes_per_second, 0.0);
+	bandwidth_credit = bandwidth_limit;
+}
+
+void PublishScheduler::set_max_topics_per_frame(size_t n)
+{
+	max_topics_per_frame = n;
+}
+
+void PublishScheduler::collect_due(double now, std::vector<std::string>& due_out)
+{
+	due_out.clear();
+
+	// refill bandwidth credit (bursts are limited to one second's worth of bandwidth)
+	if (bandwidth_limit > 0.0 && last_refill >= 0.0) {
+		bandwidth_credit = std::min(bandwidth_credit + (now - last_refill) * bandwidth_limit, bandwidth_limit);
+	}
+	last_refill = now;
+
+	std::vector<Topic*> due;
+	for (auto& kv_pair : topics) {
+		if (kv_pair.second.next_due <= now) {
+			due.push_back(&kv_pair.second);
+		}
+	}
+
+	// highest priority first, then most overdue first
+	std::sort(due.begin(), due.end(), [](const Topic* a, const Topic* b) {
+		return (a->priority != b->priority) ? a->priority > b->priority : a->next_due < b->next_due;
+	});
+
+	double available = bandwidth_credit;
+	for (Topic* p_topic : due) {
+
+		// remaining due topics are carried over to the next frame
+		if (max_topics_per_frame > 0 && due_out.size() >= max_topics_per_frame) {
+			break;
+		}
+
+		// topics that do not fit in the bandwidth budget skip this publication cycle (a full budget always admits one topic, so
+		// messages larger than the per-second limit are still published)
+		if (bandwidth_limit > 0.0 && p_topic->avg_bytes > available && available < bandwidth_limit) {
+			advance(*p_topic, now);
+			p_topic->n_skipped++;
+			continue;
+		}
+
+		available -= p_topic->avg_bytes;
+		due_out.push_back(p_topic->name);
+
+		advance(*p_topic, now);
+	}
+}
+
+void PublishScheduler::advance(Topic& topic, double now)
+{
+	// advance by whole intervals past now: publications missed while falling behind (e.g., during a frame hitch) are not made up in
+	// a burst, and the topic keeps its staggered phase
+	if (topic.next_due <= now) {
+		topic.next_due += (std::floor((now - topic.next_due) / topic.interval) + 1.0) * topic.interval;
+	}
+
+	// guards against rounding leaving the topic due on the same frame
+	if (topic.next_due <= now) {
+		topic.next_due += topic.interval;
+	}
+}
+
+void PublishScheduler::record_published(const std::string& name, size_t bytes)
+{
+	if (bandwidth_limit > 0.0) {
+		bandwidth_credit -= double(bytes);
+	}
+
+	auto search = topics.find(name);
+	if (search == topics.end()) {
+		return;
+	}
+
+	Topic& topic = search->second;
+	topic.avg_bytes = (topic.n_published == 0) ? double(bytes) : topic.avg_bytes + MESSAGE_SIZE_SMOOTHING * (double(bytes) - topic.avg_bytes);
+	topic.n_published++;
+}
+
+const PublishScheduler::Topic* PublishScheduler::get_topic(const std::string& name) const
+{
+	auto search = topics.find(name);
+	return (search != topics.end()) ? &search->second : nullptr;
+}
@@ -0,0 +1,29 @@
+#include "snapshot.h"
+
+using namespace std;
+using namespace gab;
+
+/* Implementation of SnapshotCache Class
+ ****************************************/
+void SnapshotCache::store(const std::string& topic, std::string content)
+{
+	// allocation happens outside the lock
+	auto snapshot = std::make_shared<const std::string>(std::move(content));
+
+	std::unique_lock<std::shared_mutex> lock(mutex);
+	snapshots[topic].swap(snapshot);
+}
+
+std::shared_ptr<const std::string> SnapshotCache::load(const std::string& topic) const
+{
+	std::shared_lock<std::shared_mutex> lock(mutex);
+
+	auto search = snapshots.find(topic);
+	return (search != snapshots.end()) ? search->second : nullptr;
+}
+
+void SnapshotCache::clear()
+{
+	std::unique_lock<std::shared_mutex> lock(mutex);
+	snapshots.clear();
+}
@@ -0,0 +1,660 @@
+#include "transport.h"
+
+#if defined(_WIN32)
+	#define WIN32_LEAN_AND_MEAN
+	#define NOMINMAX
+	#define NOGDI
+	#include <windows.h>
+#else
+	#include <pthread.h>
+	#include <sched.h>
+#endif
+
+using namespace std;
+using namespace gab;
+
+/* Implementation of Listener Class
+ ***********************************/
+static std::atomic<uint64_t> n_listeners(0);  // distinguishes the control endpoints of listeners created in this process
+
+Listener::Listener(zmq::context_t& zmq_context, std::map<int, int> socket_options, uint16_t port, RequestHandler& handler)
+	: p_socket(nullptr),
+	  p_control(nullptr),
+	  p_control_sender(nullptr),
+	  port(port),
+	  seqno(1),
+	  busy_poll_time(0),
+	  handler(handler)
+{
+	// sockets left open would block the context's termination forever, so a failed construction closes those already created
+	try {
+		// initialize socket
+		p_socket = new zmq::socket_t(zmq_context, ZMQ_REP);
+
+		// set socket options
+		set_options(*p_socket, socket_options);
+
+		// bind socket connection
+		std::string endpoint = construct_endpoint(port);
+		bind_socket(*p_socket, endpoint);
+
+		// initialize control channel (inproc endpoints must be bound before they are connected)
+		std::string control_endpoint = construct_control_endpoint(port, n_listeners++);
+
+		std::map<int, int> control_options = { {ZMQ_LINGER, 0} };
+
+		p_control = new zmq::socket_t(zmq_context, ZMQ_PAIR);
+		set_options(*p_control, control_options);
+		p_control->bind(control_endpoint);
+
+		p_control_sender = new zmq::socket_t(zmq_context, ZMQ_PAIR);
+		set_options(*p_control_sender, control_options);
+		p_control_sender->connect(control_endpoint);
+
+		if (verbosity >= INFO) {
+			std::cerr << "Godot-AI-Bridge: listener connected to " << endpoint << std::endl;
+		}
+	}
+	catch (...) {
+		close_sockets();
+		throw;
+	}
+}
+
+Listener::~Listener()
+{
+	close_sockets();
+}
+
+void Listener::close_sockets()
+{
+	delete p_control_sender;
+	delete p_control;
+	delete p_socket;
+
+	p_control_sender = nullptr;
+	p_control = nullptr;
+	p_socket = nullptr;
+}
+
+void Listener::operator()()
+{
+	if (verbosity >= INFO) {
+		std::cerr << "Godot-AI-Bridge: listener receiving requests" << std::endl;
+	}
+
+	zmq_pollitem_t items[] = {
+		{ static_cast<void*>(*p_socket), 0, ZMQ_POLLIN, 0 },
+		{ static_cast<void*>(*p_control), 0, ZMQ_POLLIN, 0 },
+	};
+
+	// adaptive busy-poll: after each request the listener spins with non-blocking polls until spin_deadline, so bursts of requests
+	// (e.g., one per training step) are picked up without a wake-up from blocking. once traffic pauses, it falls back to blocking.
+	std::chrono::steady_clock::time_point spin_deadline = std::chrono::steady_clock::now();
+
+	for (;;) {
+		bool is_spinning = busy_poll_time.count() > 0 && std::chrono::steady_clock::now() < spin_deadline;
+
+		// wait for next request from client (or a shutdown request)
+		int n_ready = zmq_poll(items, 2, is_spinning ? 0 : -1);
+		if (n_ready < 0) {
+			if (zmq_errno() == EINTR) {
+				continue;
+			}
+
+			if (verbosity >= ERROR) {
+				std::cerr << "Godot-AI-Bridge: listener poll failed -> " << zmq_strerror(zmq_errno()) << std::endl;
+			}
+			break;
+		}
+
+		if (n_ready == 0) {
+			continue;
+		}
+
+		if (items[1].revents & ZMQ_POLLIN) {
+			break;
+		}
+
+		if (items[0].revents & ZMQ_POLLIN) {
+			zmq::message_t request;
+
+			if (p_socket->recv(request, zmq::recv_flags::dontwait)) {
+				receive(request);
+				spin_deadline = std::chrono::steady_clock::now() + busy_poll_time;
+			}
+		}
+	}
+
+	if (verbosity >= INFO) {
+		std::cerr << "Godot-AI-Bridge: listener stopped" << std::endl;
+	}
+}
+
+void Listener::stop()
+{
+	zmq::message_t stop_request;
+	p_control_sender->send(stop_request, zmq::send_flags::none);
+}
+
+void Listener::reset_seqno()
+{
+	seqno = 1;
+}
+
+void Listener::set_busy_poll_time(std::chrono::microseconds t)
+{
+	busy_poll_time = t;
+}
+
+void Listener::receive(const zmq::message_t& request)
+{
+	if (verbosity >= DEBUG) {
+		std::cerr << "Godot-AI-Bridge: listener received request (seqno: " << seqno << ") " << std::endl;
+	}
+
+	if (verbosity >= TRACE) {
+		std::cerr << "Godot-AI-Bridge: request contents -> " << (char*)request.data() << std::endl;
+	}
+
+	std::string parse_errors = "";
+	zmq::message_t reply;
+
+	try {
+		const char* p_begin = static_cast<const char*>(request.data());
+		json j = json::parse(p_begin, p_begin + request.size());
+
+		// queries are answered from the snapshot cache on this thread (no round trip through Godot)
+		if (is_query_request(j)) {
+			reply = create_query_reply(seqno, j[MSG_DATA][QUERY].get<std::string>());
+		}
+		else if (is_batch_request(j)) {
+			std::vector<std::string> event_errors;
+			handler.notify_batch(j, event_errors);
+			reply = create_batch_reply(seqno, event_errors);
+		}
+
+		// credit grants are applied on this thread (the publisher picks them up on its next frame)
+		else if (is_credit_request(j)) {
+			reply = create_credit_reply(seqno, j[MSG_DATA]);
+		}
+		else {
+			handler.notify(j, parse_errors);
+			reply = create_reply(seqno, parse_errors);
+		}
+	}
+	catch (const json::parse_error& e) {
+		if (verbosity >= ERROR) {
+			std::cerr << "Godot-AI-Bridge: errors occurred when parsing request -> " << e.what() << std::endl;
+		}
+
+		parse_errors = e.what();
+		reply = create_reply(seqno, parse_errors);
+	}
+
+	// any other JSON error (e.g., an element of an unexpected type) rejects the request but keeps the listener serving
+	catch (const json::exception& e) {
+		if (verbosity >= ERROR) {
+			std::cerr << "Godot-AI-Bridge: errors occurred when processing request -> " << e.what() << std::endl;
+		}
+
+		parse_errors = e.what();
+		reply = create_reply(seqno, parse_errors);
+	}
+
+	if (verbosity >= DEBUG) {
+		std::cerr << "Godot-AI-Bridge: listener sending reply (seqno: " << seqno << ") " << std::endl;
+	}
+
+	if (verbosity >= TRACE) {
+		std::cerr << "Godot-AI-Bridge: reply contents -> " << (char*)reply.data() << std::endl;
+	}
+
+	p_socket->send(reply, zmq::send_flags::none);
+
+	seqno++;
+}
+
+zmq::message_t Listener::create_reply(const uint64_t seqno, const std::string& parse_errors)
+{
+	json marshaler;
+	json& header = marshaler[MSG_HEADER];
+	json& data = marshaler[MSG_DATA];
+
+	construct_message_header(header, seqno, handler.get_epoch());
+
+	// SUCCESS reply
+	if (parse_errors.empty())
+	{
+		data[REPLY_STATUS] = STATUS_SUCCESS;
+	}
+
+	// ERROR reply
+	else
+	{
+		data[REPLY_STATUS] = STATUS_ERROR;
+		data[REPLY_REASON] = parse_errors;
+	}
+
+	return construct_message(marshaler.dump());
+}
+
+zmq::message_t Listener::create_batch_reply(const uint64_t seqno, const std::vector<std::string>& event_errors)
+{
+	json marshaler;
+	json& header = marshaler[MSG_HEADER];
+	json& data = marshaler[MSG_DATA];
+
+	construct_message_header(header, seqno, handler.get_epoch());
+
+	size_t n_rejected = 0;
+
+	// one status per event (in request order)
+	json& results = data[REPLY_RESULTS] = json::array();
+	for (const std::string& errors : event_errors) {
+		json result;
+		if (errors.empty()) {
+			result[REPLY_STATUS] = STATUS_SUCCESS;
+		}
+		else {
+			result[REPLY_STATUS] = STATUS_ERROR;
+			result[REPLY_REASON] = errors;
+			n_rejected++;
+		}
+		results.push_back(std::move(result));
+	}
+
+	// SUCCESS reply (all events accepted)
+	if (n_rejected == 0) {
+		data[REPLY_STATUS] = STATUS_SUCCESS;
+	}
+
+	// ERROR reply (one or more events rejected)
+	else {
+		data[REPLY_STATUS] = STATUS_ERROR;
+		data[REPLY_REASON] = std::to_string(n_rejected) + " of " + std::to_string(event_errors.size()) + " events rejected";
+	}
+
+	return construct_message(marshaler.dump());
+}
+
+zmq::message_t Listener::create_credit_reply(const uint64_t seqno, const json& data)
+{
+	std::string topic;
+	if (data.contains(CREDIT_TOPIC)) {
+		if (!data[CREDIT_TOPIC].is_string()) {
+			return create_reply(seqno, "credit topic must be a string");
+		}
+
+		topic = data[CREDIT_TOPIC].get<std::string>();
+	}
+
+	int64_t n_credit = data[CREDIT].get<int64_t>();
+
+	try {
+		int64_t available = handler.grant_credit(topic, n_credit);
+
+		if (verbosity >= DEBUG) {
+			std::cerr << "Godot-AI-Bridge: listener granted credit (topic: " << (topic.empty() ? "*" : topic) << ", credit: " << n_credit << ", available: " << available << ")" << std::endl;
+		}
+
+		json marshaler;
+		construct_message_header(marshaler[MSG_HEADER], seqno, handler.get_epoch());
+
+		json& reply_data = marshaler[MSG_DATA];
+		reply_data[REPLY_STATUS] = STATUS_SUCCESS;
+		reply_data[REPLY_CREDIT] = available;
+
+		return construct_message(marshaler.dump());
+	}
+	catch (GodotAiBridgeException& e) {
+		if (verbosity >= WARNING) {
+			std::cerr << "Godot-AI-Bridge: listener refused credit grant -> " << e.what() << std::endl;
+		}
+
+		return create_reply(seqno, e.what());
+	}
+}
+
+zmq::message_t Listener::create_query_reply(const uint64_t seqno, const std::string& topic)
+{
+	std::shared_ptr<const std::string> snapshot = handler.get_snapshot(topic);
+
+	if (verbosity >= DEBUG) {
+		std::cerr << "Godot-AI-Bridge: listener answering query (topic: " << topic << ", cached: " << (snapshot ? "yes" : "no") << ")" << std::endl;
+	}
+
+	if (!snapshot) {
+		return create_reply(seqno, "no message has been published on topic " + topic);
+	}
+
+	json header;
+	construct_message_header(header, seqno, handler.get_epoch());
+
+	json data;
+	data[REPLY_STATUS] = STATUS_SUCCESS;
+	data[REPLY_TOPIC] = topic;
+
+	// the cached message is already serialized, so it is spliced into the reply's data element instead of being re-parsed
+	std::string data_content = data.dump();
+	data_content.pop_back();
+
+	std::string reply_content;
+	reply_content.reserve(data_content.length() + snapshot->length() + 64);
+	reply_content += "{\"";
+	reply_content += MSG_HEADER;
+	reply_content += "\":";
+	reply_content += header.dump();
+	reply_content += ",\"";
+	reply_content += MSG_DATA;
+	reply_content += "\":";
+	reply_content += data_content;
+	reply_content += ",\"";
+	reply_content += REPLY_MESSAGE;
+	reply_content += "\":";
+	reply_content += *snapshot;
+	reply_content += "}}";
+
+	return construct_message(reply_content);
+}
+
+
+/* Implementation of Publisher Class 
+ ************************************/
+Publisher::Publisher(zmq::context_t& zmq_context, std::map<int, int> socket_options, uint16_t port)
+	: p_socket(nullptr),
+	  port(port),
+	  seqno(1)
+{
+	// initialize socket
+	p_socket = new zmq::socket_t(zmq_context, ZMQ_XPUB);
+
+	// a socket left open (e.g., when the port is taken) would block the context's termination forever
+	try {
+		// set socket options
+		set_options(*p_socket, socket_options);
+
+		// bind socket connection
+		std::string endpoint = construct_endpoint(port);
+		bind_socket(*p_socket, endpoint);
+
+		if (verbosity >= INFO) {
+			std::cerr << "Godot-AI-Bridge: publisher connected to " << endpoint << std::endl;
+		}
+	}
+	catch (...) {
+		delete p_socket;
+		throw;
+	}
+}
+
+Publisher::~Publisher()
+{
+	delete p_socket;
+}
+
+bool Publisher::publish(const std::string& topic, const std::string& content)
+{
+	try
+	{
+		zmq::message_t message = construct_topic_message(topic, content);
+
+		if (verbosity >= DEBUG) {
+			std::cerr << "Godot-AI-Bridge: publishing message (seqno: " << seqno << ", topic: " << topic << ") " << std::endl;
+		}
+
+		if (verbosity >= TRACE) {
+			std::cerr << "Godot-AI-Bridge: message contents -> " << content << std::endl;
+		}
+
+		update_subscriptions();
+
+		// zmq would discard a message nobody subscribed to without telling the caller
+		if (!is_subscribed(message)) {
+			if (verbosity >= DEBUG) {
+				std::cerr << "Godot-AI-Bridge: publisher dropped message without subscribers (seqno: " << seqno << ", topic: " << topic << ")" << std::endl;
+			}
+			seqno++;
+			return false;
+		}
+
+		// never blocks the caller. a full queue (EAGAIN, only reported with ZMQ_XPUB_NODROP) drops the message.
+		if (!p_socket->send(message, zmq::send_flags::dontwait)) {
+			if (verbosity >= DEBUG) {
+				std::cerr << "Godot-AI-Bridge: publisher dropped message (seqno: " << seqno << ", topic: " << topic << ")" << std::endl;
+			}
+			seqno++;
+			return false;
+		}
+
+		seqno++;
+		return true;
+	}
+
+	// any other failure (e.g., ETERM) is an error, not a sign of consumers falling behind
+	catch (const zmq::error_t& e)
+	{
+		throw GodotAiBridgeException(std::string("unable to publish message (topic: ") + topic + ") -> " + e.what());
+	}
+}
+
+// subscription messages start with 1 (subscribe) or 0 (unsubscribe), followed by the prefix. other messages from consumers are ignored.
+void Publisher::update_subscriptions()
+{
+	zmq::message_t message;
+	while (p_socket->recv(message, zmq::recv_flags::dontwait)) {
+		if (message.size() == 0) {
+			continue;
+		}
+
+		const char* p_data = static_cast<const char*>(message.data());
+		std::string prefix(p_data + 1, message.size() - 1);
+
+		if (p_data[0] == 1) {
+			subscriptions.insert(std::move(prefix));
+		}
+		else if (p_data[0] == 0) {
+			subscriptions.erase(prefix);
+		}
+	}
+}
+
+bool Publisher::is_subscribed(const zmq::message_t& message) const
+{
+	const char* p_data = static_cast<const char*>(message.data());
+
+	for (const std::string& prefix : subscriptions) {
+		if (prefix.length() <= message.size() && memcmp(p_data, prefix.data(), prefix.length()) == 0) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+uint64_t Publisher::get_seqno()
+{
+	return seqno;
+}
+
+void Publisher::reset_seqno()
+{
+	seqno = 1;
+}
+
+void gab::bind_socket(zmq::socket_t& socket, const std::string& endpoint)
+{
+	static const int MAX_BIND_ATTEMPTS = 20;
+	static const std::chrono::milliseconds BIND_RETRY_DELAY(10);
+
+	for (int attempt = 1; ; attempt++) {
+		try {
+			socket.bind(endpoint);
+			return;
+		}
+		catch (const zmq::error_t& e) {
+			if (e.num() != EADDRINUSE || attempt >= MAX_BIND_ATTEMPTS) {
+				throw;
+			}
+
+			std::this_thread::sleep_for(BIND_RETRY_DELAY);
+		}
+	}
+}
+
+// Applies io thread settings to a zmq context (before its first socket is created)
+void gab::set_context_options(zmq::context_t& context, const PerformanceOptions& options)
+{
+	void* p_context = static_cast<void*>(context);
+
+	// zero io threads would leave the tcp transport without any thread to run on
+	if (options.io_threads == 0) {
+		if (verbosity >= WARNING) {
+			std::cerr << "Godot-AI-Bridge: at least one zmq io thread is required (io_threads ignored)" << std::endl;
+		}
+	}
+	else if (options.io_threads > 0) {
+		if (zmq_ctx_set(p_context, ZMQ_IO_THREADS, options.io_threads) != 0) {
+			if (verbosity >= WARNING) {
+				std::cerr << "Godot-AI-Bridge: unable to set zmq io threads to " << options.io_threads << " -> " << zmq_strerror(zmq_errno()) << std::endl;
+			}
+		}
+		else if (verbosity >= DEBUG) {
+			std::cerr << "Godot-AI-Bridge: setting zmq io threads to " << options.io_threads << std::endl;
+		}
+	}
+
+#if defined(ZMQ_THREAD_AFFINITY_CPU_ADD)
+	for (int cpu : options.io_thread_cpus) {
+
+		// zmq pins each io thread as it starts and aborts the process if that fails, so only CPUs this process may run on are given
+		if (!is_usable_cpu(cpu)) {
+			if (verbosity >= WARNING) {
+				std::cerr << "Godot-AI-Bridge: cpu " << cpu << " is not available to this process (io thread pinning ignored)" << std::endl;
+			}
+			continue;
+		}
+
+		if (zmq_ctx_set(p_context, ZMQ_THREAD_AFFINITY_CPU_ADD, cpu) != 0) {
+			if (verbosity >= WARNING) {
+				std::cerr << "Godot-AI-Bridge: unable to pin zmq io threads to cpu " << cpu << " -> " << zmq_strerror(zmq_errno()) << std::endl;
+			}
+		}
+		else if (verbosity >= DEBUG) {
+			std::cerr << "Godot-AI-Bridge: pinning zmq io threads to cpu " << cpu << std::endl;
+		}
+	}
+#else
+	if (!options.io_thread_cpus.empty() && verbosity >= WARNING) {
+		std::cerr << "Godot-AI-Bridge: io thread affinity not supported by this version of ZeroMQ (ignored)" << std::endl;
+	}
+#endif
+
+	if (options.io_thread_priority.has_value()) {
+		int priority = options.io_thread_priority.value();
+
+#if defined(ZMQ_THREAD_PRIORITY) && defined(ZMQ_THREAD_SCHED_POLICY) && !defined(_WIN32)
+		// zmq applies the priority on each io thread and aborts the process if that fails. without a scheduling policy it falls
+		// back to nice(-20), which fails for unprivileged processes, so the policy is always given and the privilege probed first.
+		if (can_set_realtime_priority(priority)) {
+			if (zmq_ctx_set(p_context, ZMQ_THREAD_SCHED_POLICY, SCHED_FIFO) != 0 || zmq_ctx_set(p_context, ZMQ_THREAD_PRIORITY, priority) != 0) {
+				if (verbosity >= WARNING) {
+					std::cerr << "Godot-AI-Bridge: unable to set zmq io thread priority to " << priority << " -> " << zmq_strerror(zmq_errno()) << std::endl;
+				}
+			}
+			else if (verbosity >= DEBUG) {
+				std::cerr << "Godot-AI-Bridge: setting zmq io thread priority to " << priority << std::endl;
+			}
+		}
+		else if (verbosity >= WARNING) {
+			std::cerr << "Godot-AI-Bridge: not permitted to set zmq io thread priority to " << priority << " (ignored)" << std::endl;
+		}
+#else
+		if (verbosity >= WARNING) {
+			std::cerr << "Godot-AI-Bridge: io thread priority not supported on this platform or version of ZeroMQ (ignored)" << std::endl;
+		}
+#endif
+	}
+}
+
+bool gab::can_set_realtime_priority(int priority)
+{
+#if defined(_WIN32)
+	return false;
+#else
+	bool is_permitted = false;
+
+	// the probe changes only its own thread's scheduling, which ends with the thread
+	std::thread probe([priority, &is_permitted]() {
+		sched_param param;
+		param.sched_priority = priority;
+
+		is_permitted = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) == 0;
+	});
+	probe.join();
+
+	return is_permitted;
+#endif
+}
+
+bool gab::is_usable_cpu(int cpu)
+{
+	if (cpu < 0) {
+		return false;
+	}
+
+#if defined(_WIN32)
+	// affinity masks hold one bit per CPU (of the current processor group)
+	DWORD_PTR process_mask = 0;
+	DWORD_PTR system_mask = 0;
+	if (size_t(cpu) >= sizeof(DWORD_PTR) * 8 || !GetProcessAffinityMask(GetCurrentProcess(), &process_mask, &system_mask)) {
+		return false;
+	}
+
+	return (process_mask & (DWORD_PTR(1) << cpu)) != 0;
+#elif defined(__linux__)
+	// the affinity mask also excludes CPUs outside the process's cpuset (e.g., in containers)
+	cpu_set_t cpus;
+	CPU_ZERO(&cpus);
+	if (cpu >= CPU_SETSIZE || sched_getaffinity(0, sizeof(cpus), &cpus) != 0) {
+		return false;
+	}
+
+	return CPU_ISSET(cpu, &cpus);
+#else
+	return unsigned(cpu) < std::thread::hardware_concurrency();
+#endif
+}
+
+// Pins a thread to a CPU
+bool gab::set_thread_affinity(std::thread& thread, int cpu)
+{
+	if (!is_usable_cpu(cpu)) {
+		return false;
+	}
+
+#if defined(_WIN32)
+	return SetThreadAffinityMask(thread.native_handle(), DWORD_PTR(1) << cpu) != 0;
+#elif defined(__linux__)
+	cpu_set_t cpus;
+	CPU_ZERO(&cpus);
+	CPU_SET(cpu, &cpus);
+
+	return pthread_setaffinity_np(thread.native_handle(), sizeof(cpus), &cpus) == 0;
+#else
+	return false;  // thread affinity is not supported on this platform (e.g., osx)
+#endif
+}
+
+// Sets a thread's scheduling priority (Windows: THREAD_PRIORITY_* value; otherwise: SCHED_FIFO priority, which requires privileges)
+bool gab::set_thread_priority(std::thread& thread, int priority)
+{
+#if defined(_WIN32)
+	return SetThreadPriority(thread.native_handle(), priority) != 0;
+#else
+	sched_param param;
+	param.sched_priority = priority;
+
+	return pthread_setschedparam(thread.native_handle(), SCHED_FIFO, &param) == 0;
+#endif
+}
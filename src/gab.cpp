@@ -5,27 +5,37 @@ using namespace gab;
 
 /* Implementation of GodotAiBridge Class
  ****************************************/
-GodotAiBridge::GodotAiBridge() : zmq_context() {
+GodotAiBridge::GodotAiBridge()
+	: zmq_context(),
+	  p_listener(nullptr),
+	  p_publisher(nullptr),
+	  p_listener_thread(nullptr),
+	  connected_publisher_port(0),
+	  connected_listener_port(0),
+	  is_context_started(false),
+	  epoch(1)
+{
 
 }
 
 GodotAiBridge::~GodotAiBridge() {
-	if (p_listener != nullptr)
-		delete p_listener;
-
-	if (p_publisher != nullptr)
-		delete p_publisher;
-
-	if (p_listener_thread != nullptr)
-		delete p_listener_thread;
+	disconnect();
 }
 
 
 void GodotAiBridge::_register_methods() {
 	godot::register_method("connect", &GodotAiBridge::connect);
 	godot::register_method("send", &GodotAiBridge::send);
+	godot::register_method("register_topic", &GodotAiBridge::register_topic);
+	godot::register_method("unregister_topic", &GodotAiBridge::unregister_topic);
+	godot::register_method("get_topic_stats", &GodotAiBridge::get_topic_stats);
+	godot::register_method("disconnect", &GodotAiBridge::disconnect);
+	godot::register_method("reset", &GodotAiBridge::reset);
+	godot::register_method("is_connected", &GodotAiBridge::is_connected);
+	godot::register_method("_process", &GodotAiBridge::_process);
 	
 	godot::register_signal<gab::GodotAiBridge>("event_requested", "event_details", GODOT_VARIANT_TYPE_DICTIONARY);
+	godot::register_signal<gab::GodotAiBridge>("backpressure", "backpressure_details", GODOT_VARIANT_TYPE_DICTIONARY);
 }
 
 void GodotAiBridge::_init() {
@@ -41,6 +51,9 @@ void GodotAiBridge::connect(godot::Variant v_options) {
 		std::map<int, int> publisher_options(DEFAULT_PUBLISHER_OPTIONS);
 		std::map<int, int> listener_options(DEFAULT_LISTENER_OPTIONS);
 
+		PerformanceOptions performance_options;
+		FlowControlOptions flow_options;
+
 		if (is_dictionary_variant(v_options)) {
 			godot::Dictionary option_dict(v_options);
 
@@ -48,6 +61,11 @@ void GodotAiBridge::connect(godot::Variant v_options) {
 			static const godot::String LISTENER_PORT = "listener_port";
 			static const godot::String SOCKET_OPTIONS = "socket_options";
 			static const godot::String VERBOSITY = "verbosity";
+			static const godot::String SCHEDULER = "scheduler";
+			static const godot::String BANDWIDTH_LIMIT = "bandwidth_limit";
+			static const godot::String MAX_TOPICS_PER_FRAME = "max_topics_per_frame";
+			static const godot::String PERFORMANCE = "performance";
+			static const godot::String FLOW_CONTROL = "flow_control";
 
 			if (option_dict.has(VERBOSITY)) {
 				verbosity = (int)convert_int(option_dict[VERBOSITY]);
@@ -77,249 +95,534 @@ void GodotAiBridge::connect(godot::Variant v_options) {
 				godot::Variant socket_opts = option_dict[SOCKET_OPTIONS];
 
 				if (is_dictionary_variant(socket_opts)) {
-					map_options(socket_opts, publisher_options);
-					map_options(socket_opts, listener_options);
+					map_options(socket_opts, publisher_options, true);
+					map_options(socket_opts, listener_options, false);
 				}
 
 				if (verbosity >= DEBUG) {
 					std::cerr << "Godot-AI-Bridge: using custom socket options" << std::endl;
 				}
 			}
+
+			if (option_dict.has(SCHEDULER)) {
+				godot::Variant scheduler_opts = option_dict[SCHEDULER];
+
+				if (is_dictionary_variant(scheduler_opts)) {
+					godot::Dictionary scheduler_dict(scheduler_opts);
+
+					if (scheduler_dict.has(BANDWIDTH_LIMIT)) {
+						scheduler.set_bandwidth_limit(convert_real(scheduler_dict[BANDWIDTH_LIMIT]));
+
+						if (verbosity >= DEBUG) {
+							std::cerr << "Godot-AI-Bridge: setting scheduler bandwidth limit to " << convert_real(scheduler_dict[BANDWIDTH_LIMIT]) << " bytes/sec" << std::endl;
+						}
+					}
+
+					if (scheduler_dict.has(MAX_TOPICS_PER_FRAME)) {
+						scheduler.set_max_topics_per_frame((size_t)std::max<int64_t>(convert_int(scheduler_dict[MAX_TOPICS_PER_FRAME]), 0));
+
+						if (verbosity >= DEBUG) {
+							std::cerr << "Godot-AI-Bridge: setting scheduler max topics per frame to " << convert_int(scheduler_dict[MAX_TOPICS_PER_FRAME]) << std::endl;
+						}
+					}
+				}
+			}
+
+			if (option_dict.has(PERFORMANCE)) {
+				godot::Variant performance_opts = option_dict[PERFORMANCE];
+
+				if (is_dictionary_variant(performance_opts)) {
+					map_performance_options(performance_opts, performance_options);
+				}
+
+				if (verbosity >= DEBUG) {
+					std::cerr << "Godot-AI-Bridge: using custom performance options" << std::endl;
+				}
+			}
+
+			if (option_dict.has(FLOW_CONTROL)) {
+				godot::Variant flow_opts = option_dict[FLOW_CONTROL];
+
+				if (is_dictionary_variant(flow_opts)) {
+					map_flow_control_options(flow_opts, flow_options);
+				}
+
+				if (verbosity >= DEBUG) {
+					std::cerr << "Godot-AI-Bridge: using custom flow control options (credit: " << (flow_options.is_credit_enabled ? "enabled" : "disabled") << ")" << std::endl;
+				}
+			}
+		}
+
+		// flow control settings do not affect the sockets (they are applied without reconnecting)
+		if (!(flow_options == connected_flow_options)) {
+			flow.configure(flow_options);
+			connected_flow_options = flow_options;
 		}
 			
+
+		// existing sockets are reused when the connection settings are unchanged (e.g., when "connect" is called again after a scene reload)
+		if (is_connected()) {
+			if (publisher_port == connected_publisher_port && listener_port == connected_listener_port
+				&& publisher_options == connected_publisher_options && listener_options == connected_listener_options
+				&& performance_options == connected_performance_options) {
+
+				if (verbosity >= INFO) {
+					std::cerr << "Godot-AI-Bridge: reusing existing connection" << std::endl;
+				}
+				return;
+			}
+
+			disconnect();
+		}
+
+		if (!is_context_started) {
+			set_context_options(zmq_context, performance_options);
+			is_context_started = true;
+		}
+		else if (performance_options.io_threads >= 0 || !performance_options.io_thread_cpus.empty() || performance_options.io_thread_priority.has_value()) {
+			if (verbosity >= WARNING) {
+				std::cerr << "Godot-AI-Bridge: io thread settings only apply to the first call to \"connect\" (ignored)" << std::endl;
+			}
+		}
+
 		p_publisher = new Publisher(zmq_context, publisher_options, publisher_port);
 		p_listener = new Listener(zmq_context, listener_options, listener_port, *this);
-		
+		p_listener->set_busy_poll_time(std::chrono::microseconds(performance_options.busy_poll_us));
+
+		connected_publisher_port = publisher_port;
+		connected_listener_port = listener_port;
+		connected_publisher_options = publisher_options;
+		connected_listener_options = listener_options;
+		connected_performance_options = performance_options;
+
 		// start event listener thread
-		p_listener_thread = new thread(*p_listener);
+		p_listener_thread = new thread(std::ref(*p_listener));
+
+		if (performance_options.listener_cpu >= 0 && !set_thread_affinity(*p_listener_thread, performance_options.listener_cpu)) {
+			if (verbosity >= WARNING) {
+				std::cerr << "Godot-AI-Bridge: unable to pin listener thread to cpu " << performance_options.listener_cpu << std::endl;
+			}
+		}
+
+		if (performance_options.listener_priority.has_value() && !set_thread_priority(*p_listener_thread, performance_options.listener_priority.value())) {
+			if (verbosity >= WARNING) {
+				std::cerr << "Godot-AI-Bridge: unable to set listener thread priority to " << performance_options.listener_priority.value() << std::endl;
+			}
+		}
 	}
 	catch (exception& e)
 	{
 		std::cerr << "Godot-AI-Bridge: encountered fatal exception during call to \"connect\" -> " << e.what() << std::endl;
+
+		// release any partially constructed connection
+		disconnect();
 	}
 }
 
-// emit signal to Godot with event details
-void GodotAiBridge::notify(const zmq::message_t& request, std::string& parse_errors) {
-	char* buffer = new char[request.size() + 1];
-	memcpy(buffer, request.data(), request.size());
-	buffer[request.size()] = '\0';
+void GodotAiBridge::disconnect() {
+	if (p_listener_thread != nullptr) {
+
+		// the listener thread cannot join itself (e.g., when called from an "event_requested" signal handler)
+		if (p_listener_thread->get_id() == std::this_thread::get_id()) {
+			if (verbosity >= ERROR) {
+				std::cerr << "Godot-AI-Bridge: \"disconnect\" cannot be called from the listener thread (use call_deferred)" << std::endl;
+			}
+			return;
+		}
+
+		p_listener->stop();
+		p_listener_thread->join();
 
+		delete p_listener_thread;
+		p_listener_thread = nullptr;
+	}
+
+	if (p_listener != nullptr) {
+		delete p_listener;
+		p_listener = nullptr;
+	}
+
+	if (p_publisher != nullptr) {
+		delete p_publisher;
+		p_publisher = nullptr;
+	}
+
+	snapshots.clear();
+
+	flow.clear_credit();
+	flow.clear_held();
+	flow.clear_backpressure();
+
+	if (verbosity >= INFO) {
+		std::cerr << "Godot-AI-Bridge: disconnected" << std::endl;
+	}
+}
+
+void GodotAiBridge::reset() {
+	uint64_t new_epoch = ++epoch;
+
+	if (p_publisher != nullptr) {
+		p_publisher->reset_seqno();
+	}
+
+	if (p_listener != nullptr) {
+		p_listener->reset_seqno();
+	}
+
+	// state cached (or held for credit) during the previous epoch must not be delivered in the new one. granted credit is kept.
+	snapshots.clear();
+	flow.clear_held();
+	flow.clear_backpressure();
+
+	if (verbosity >= INFO) {
+		std::cerr << "Godot-AI-Bridge: reset (epoch: " << new_epoch << ")" << std::endl;
+	}
+}
+
+bool GodotAiBridge::is_connected() {
+	return p_publisher != nullptr && p_listener != nullptr;
+}
+
+uint64_t GodotAiBridge::get_epoch() const {
+	return epoch;
+}
+
+// emit signal to Godot with event details
+void GodotAiBridge::notify(json& request, std::string& parse_errors) {
 	if (verbosity >= DEBUG) {
 		std::cout << "Godot-AI-Bridge: emitting \"event_requested\" signal to Godot" << std::endl;
 	}
 
 	try {
-		auto j = json::parse(buffer);
-		godot::Variant v = unmarshal_to_variant(j);
+		godot::Variant v = unmarshal_to_variant(request, get_array_hint(request));
 
 		emit_signal("event_requested", v);
 	}
-	catch (const json::parse_error& e) {
-		if (verbosity >= ERROR) {
-			std::cerr << "Godot-AI-Bridge: errors occurred when parsing request -> " << e.what() << std::endl;
-		}
-		parse_errors = e.what();
-	}
 	catch (GodotAiBridgeException& e) {
 		if (verbosity >= ERROR) {
 			std::cerr << "Godot-AI-Bridge: errors occurred when receiving event request -> " << e.what() << std::endl;
 		}
+		parse_errors = e.what();
 	}
-
-	delete[] buffer;
 }
 
-void GodotAiBridge::send(const godot::Variant v_topic, const godot::Variant v_data)
-{
-	json marshaler;
-	json& header = marshaler[MSG_HEADER];
-	json& data = marshaler[MSG_DATA];
+// emit one signal to Godot with all valid events from a batch request. event_errors receives one entry per event (empty on success).
+void GodotAiBridge::notify_batch(json& request, std::vector<std::string>& event_errors) {
+	json& events = request[MSG_DATA][EVENTS];
+
+	event_errors.assign(events.size(), "");
 
 	try {
-		construct_message_header(header, p_publisher->get_seqno());
-		marshal_variant(v_data, data);
+		ArrayHint hint = get_array_hint(request);
+
+		// events are validated and unmarshaled in a single pass. invalid events are rejected individually.
+		godot::Array v_events;
+		for (size_t i = 0; i < events.size(); i++) {
+			if (!events[i].is_object()) {
+				event_errors[i] = "event must be a dictionary";
+				continue;
+			}
 
-		std::string topic = convert_string(v_topic);
-		std::string content = marshaler.dump();
+			try {
+				v_events.push_back(unmarshal_to_variant(events[i], hint));
+			}
+			catch (GodotAiBridgeException& e) {
+				event_errors[i] = e.what();
+			}
+		}
 
-		p_publisher->publish(topic, content);
+		if (v_events.empty()) {
+			return;
+		}
+
+		godot::Dictionary v_data;
+		v_data[EVENTS] = v_events;
+
+		godot::Dictionary v_request;
+		if (request.contains(MSG_HEADER)) {
+			v_request[MSG_HEADER] = unmarshal_to_variant(request[MSG_HEADER]);
+		}
+		v_request[MSG_DATA] = v_data;
+
+		if (verbosity >= DEBUG) {
+			std::cout << "Godot-AI-Bridge: emitting \"event_requested\" signal to Godot (batch of " << v_events.size() << " events)" << std::endl;
+		}
+
+		emit_signal("event_requested", v_request);
 	}
 	catch (GodotAiBridgeException& e) {
 		if (verbosity >= ERROR) {
-			std::cerr << "Godot-AI-Bridge: errors occurred when publishing message -> " << e.what() << std::endl;
+			std::cerr << "Godot-AI-Bridge: errors occurred when receiving batch request -> " << e.what() << std::endl;
 		}
+
+		// envelope errors reject every event in the batch
+		event_errors.assign(events.size(), e.what());
 	}
 }
 
-
-/* Implementation of Listener Class
- ***********************************/
-Listener::Listener(zmq::context_t& zmq_context, std::map<int, int> socket_options, uint16_t port, GodotAiBridge& bridge)
-	: seqno(1),
-	  bridge(bridge)
+std::shared_ptr<const std::string> GodotAiBridge::get_snapshot(const std::string& topic) const
 {
-	// initialize socket
-	p_socket = new zmq::socket_t(zmq_context, ZMQ_REP);
+	return snapshots.load(topic);
+}
 
-	// set socket options
-	set_options(*p_socket, socket_options);
+int64_t GodotAiBridge::grant_credit(const std::string& topic, int64_t n)
+{
+	return flow.grant(topic, n);
+}
 
-	// bind socket connection
-	std::string endpoint = "tcp://*:" + std::to_string(port);
-	p_socket->bind(endpoint);
+godot::String GodotAiBridge::send(const godot::Variant v_topic, const godot::Variant v_data)
+{
+	size_t n_bytes = 0;
+	PublishStatus status = publish(convert_string(v_topic), v_data, n_bytes);
 
-	if (verbosity >= INFO) {
-		std::cerr << "Godot-AI-Bridge: listener connected to " << endpoint << std::endl;
-	}
+	return godot::String(get_publish_status_name(status));
 }
 
-void Listener::operator()()
+PublishStatus GodotAiBridge::publish(const std::string& topic, const godot::Variant& v_data, size_t& n_bytes_out)
 {
-	if (verbosity >= INFO) {
-		std::cerr << "Godot-AI-Bridge: listener receiving requests" << std::endl;
+	n_bytes_out = 0;
+
+	if (p_publisher == nullptr) {
+		if (verbosity >= ERROR) {
+			std::cerr << "Godot-AI-Bridge: unable to publish message before call to \"connect\" (topic: " << topic << ")" << std::endl;
+		}
+		return PUBLISH_ERROR;
 	}
 
-	for (;;) {
-		zmq::message_t request;
+	PublishStatus status = PUBLISH_ERROR;
+
+	try {
+		validate_topic(topic);
+
+		json marshaler;
+		marshal_variant(v_data, marshaler[MSG_DATA]);
 
-		// wait for next request from client
-		if (p_socket->recv(request, zmq::recv_flags::none)) {
-			receive(request);
+		// without credit the message is held until a consumer grants some (replacing any message already held for the topic)
+		CreditSource credit_source;
+		if (!flow.try_acquire(topic, credit_source)) {
+			flow.hold(topic, std::move(marshaler));
+			status = PUBLISH_QUEUED;
+		}
+		else {
+			flow.discard_held(topic);
+			status = transmit(topic, marshaler, credit_source, n_bytes_out);
+		}
+	}
+	catch (GodotAiBridgeException& e) {
+		if (verbosity >= ERROR) {
+			std::cerr << "Godot-AI-Bridge: errors occurred when publishing message -> " << e.what() << std::endl;
 		}
 	}
+
+	report_backpressure(topic, status);
+
+	return status;
 }
 
-void Listener::receive(const zmq::message_t& request)
+PublishStatus GodotAiBridge::transmit(const std::string& topic, json& marshaler, CreditSource credit_source, size_t& n_bytes_out)
 {
-	if (verbosity >= DEBUG) {
-		std::cerr << "Godot-AI-Bridge: listener received request (seqno: " << seqno << ") " << std::endl;
-	}
+	// the header is added at transmission, so held messages receive the sequence number they are actually sent with
+	construct_message_header(marshaler[MSG_HEADER], p_publisher->get_seqno(), epoch);
 
-	if (verbosity >= TRACE) {
-		std::cerr << "Godot-AI-Bridge: request contents -> " << (char*)request.data() << std::endl;
+	// nothing delivered returns the consumer's credit to the pool it was taken from
+	std::string content;
+	try {
+		content = marshaler.dump();
+	}
+	catch (const json::exception& e) {
+		flow.release(topic, credit_source);
+		throw GodotAiBridgeException(std::string("unable to serialize message (topic: ") + topic + ") -> " + e.what());
 	}
 
-	std::string parse_errors = "";
-	bridge.notify(request, parse_errors);
-
-	zmq::message_t reply = create_reply(seqno, parse_errors);
-
-	if (verbosity >= DEBUG) {
-		std::cerr << "Godot-AI-Bridge: listener sending reply (seqno: " << seqno << ") " << std::endl;
+	bool is_sent = false;
+	try {
+		is_sent = p_publisher->publish(topic, content);
+	}
+	catch (GodotAiBridgeException&) {
+		flow.release(topic, credit_source);
+		throw;
 	}
 
-	if (verbosity >= TRACE) {
-		std::cerr << "Godot-AI-Bridge: reply contents -> " << (char*)reply.data() << std::endl;
+	if (is_sent) {
+		n_bytes_out = get_topic_message_length(topic, content);
+	}
+	else {
+		flow.release(topic, credit_source);
 	}
 
-	p_socket->send(reply, zmq::send_flags::none);
+	// a message no subscriber received is still the topic's latest state (so queries are answered with it)
+	snapshots.store(topic, std::move(content));
 
-	seqno++;
+	return is_sent ? PUBLISH_SENT : PUBLISH_DROPPED;
 }
 
-zmq::message_t Listener::create_reply(const uint64_t seqno, const std::string& parse_errors)
+void GodotAiBridge::publish_held()
 {
-	json marshaler;
-	json& header = marshaler[MSG_HEADER];
-	json& data = marshaler[MSG_DATA];
-
-	construct_message_header(header, seqno);
+	flow.collect_held_topics(held_topics);
 
-	// SUCCESS reply
-	if (parse_errors.empty())
-	{
-		data["status"] = "SUCCESS";
-	}
+	for (const std::string& topic : held_topics) {
+		CreditSource credit_source;
+		if (!flow.try_acquire(topic, credit_source)) {
+			continue;
+		}
 
-	// ERROR reply
-	else
-	{
-		data["status"] = "ERROR";
-		data["reason"] = parse_errors;
-	}
+		json marshaler;
+		flow.take_held(topic, marshaler);
 
-	std::string reply_content = marshaler.dump();
+		size_t n_bytes = 0;
+		PublishStatus status = PUBLISH_ERROR;
 
-	zmq::message_t reply(reply_content.length());
-	memcpy(reply.data(), reply_content.c_str(), reply_content.length());
+		try {
+			status = transmit(topic, marshaler, credit_source, n_bytes);
+		}
+		catch (GodotAiBridgeException& e) {
+			if (verbosity >= ERROR) {
+				std::cerr << "Godot-AI-Bridge: errors occurred when publishing held message -> " << e.what() << std::endl;
+			}
+		}
 
-	return reply;
+		report_backpressure(topic, status);
+	}
 }
 
-
-/* Implementation of Publisher Class 
- ************************************/
-Publisher::Publisher(zmq::context_t& zmq_context, std::map<int, int> socket_options, uint16_t port)
-	: seqno(1)
+void GodotAiBridge::report_backpressure(const std::string& topic, PublishStatus status)
 {
-	// initialize socket
-	p_socket = new zmq::socket_t(zmq_context, ZMQ_PUB);
-
-	// set socket options
-	set_options(*p_socket, socket_options);
+	BackpressureChange change = flow.record(topic, status);
+	if (change == BACKPRESSURE_UNCHANGED) {
+		return;
+	}
 
-	// bind socket connection
-	std::string endpoint = "tcp://*:" + std::to_string(port);
-	p_socket->bind(endpoint);
+	bool is_active = (change == BACKPRESSURE_STARTED);
 
-	if (verbosity >= INFO) {
-		std::cerr << "Godot-AI-Bridge: publisher connected to " << endpoint << std::endl;
+	if (is_active && verbosity >= WARNING) {
+		std::cerr << "Godot-AI-Bridge: backpressure on topic " << topic << " (" << flow.get_undelivered(topic) << " consecutive messages undelivered)" << std::endl;
+	}
+	else if (!is_active && verbosity >= INFO) {
+		std::cerr << "Godot-AI-Bridge: backpressure relieved on topic " << topic << std::endl;
 	}
+
+	static const char* TOPIC = "topic";
+	static const char* ACTIVE = "active";
+	static const char* UNDELIVERED = "undelivered";
+
+	godot::Dictionary v_details;
+	v_details[TOPIC] = topic.c_str();
+	v_details[ACTIVE] = is_active;
+	v_details[UNDELIVERED] = flow.get_undelivered(topic);
+
+	emit_signal("backpressure", v_details);
 }
 
-void Publisher::publish(const std::string& topic, const std::string& content)
+void GodotAiBridge::register_topic(const godot::Variant v_topic, const godot::Variant v_rate, const godot::Variant v_priority, const godot::Variant v_provider)
 {
-	try
-	{
-		zmq::message_t message(get_message_length(topic, content));
-		construct_message(message, topic, content);
+	std::string topic = convert_string(v_topic);
 
-		if (verbosity >= DEBUG) {
-			std::cerr << "Godot-AI-Bridge: publishing message (seqno: " << seqno << ", topic: " << topic << ") " << std::endl;
-		}
+	try {
+		validate_topic(topic);
 
-		if (verbosity >= TRACE) {
-			std::cerr << "Godot-AI-Bridge: message contents -> " << content << std::endl;
+		godot::Ref<godot::FuncRef> provider = v_provider;
+		if (!provider.is_valid()) {
+			throw GodotAiBridgeException("state provider must be a FuncRef (topic: " + topic + ")");
 		}
 
-		p_socket->send(message, zmq::send_flags::none);
-		seqno++;
+		scheduler.add_topic(topic, convert_real(v_rate), (int)convert_int(v_priority), get_scheduler_time());
+		topic_providers[topic] = provider;
+
+		if (verbosity >= DEBUG) {
+			std::cerr << "Godot-AI-Bridge: registered topic " << topic << " (rate: " << convert_real(v_rate) << " Hz, priority: " << convert_int(v_priority) << ")" << std::endl;
+		}
 	}
-	catch (exception& e)
-	{
+	catch (GodotAiBridgeException& e) {
 		if (verbosity >= ERROR) {
-			std::cout << "Godot-AI-Bridge: encountered exception when publishing message -> " << e.what() << std::endl;
+			std::cerr << "Godot-AI-Bridge: errors occurred when registering topic -> " << e.what() << std::endl;
 		}
 	}
 }
 
-void Publisher::construct_message(zmq::message_t& msg, const std::string& topic, const std::string& payload) 
+void GodotAiBridge::unregister_topic(const godot::Variant v_topic)
 {
-	char* p_buffer = (char*)msg.data();
+	std::string topic = convert_string(v_topic);
 
-	// add topic to buffer
-	memcpy(p_buffer, topic.c_str(), topic.length());
+	scheduler.remove_topic(topic);
+	topic_providers.erase(topic);
 
-	// add space
-	p_buffer[topic.length()] = ' ';
-
-	// add message payload to buffer
-	memcpy(p_buffer + topic.length() + 1, payload.c_str(), payload.length());
+	if (verbosity >= DEBUG) {
+		std::cerr << "Godot-AI-Bridge: unregistered topic " << topic << std::endl;
+	}
 }
 
-size_t Publisher::get_message_length(const std::string& topic, const std::string& msg)
+godot::Dictionary GodotAiBridge::get_topic_stats(const godot::Variant v_topic)
 {
-	return topic.length() + msg.length() + 1; // additional character for space between topic and json
+	static const char* RATE = "rate";
+	static const char* PRIORITY = "priority";
+	static const char* PUBLISHED = "published";
+	static const char* SKIPPED = "skipped";
+	static const char* AVG_BYTES = "avg_bytes";
+
+	godot::Dictionary v_stats;
+
+	const PublishScheduler::Topic* p_topic = scheduler.get_topic(convert_string(v_topic));
+	if (p_topic != nullptr) {
+		v_stats[RATE] = 1.0 / p_topic->interval;
+		v_stats[PRIORITY] = p_topic->priority;
+		v_stats[PUBLISHED] = int64_t(p_topic->n_published);
+		v_stats[SKIPPED] = int64_t(p_topic->n_skipped);
+		v_stats[AVG_BYTES] = p_topic->avg_bytes;
+	}
+
+	return v_stats;
 }
 
-uint64_t Publisher::get_seqno()
+void GodotAiBridge::_process(float delta)
 {
-	return seqno;
+	if (p_publisher == nullptr) {
+		return;
+	}
+
+	// credit granted since the last frame releases held messages first
+	if (flow.is_credit_enabled()) {
+		publish_held();
+	}
+
+	scheduler.collect_due(get_scheduler_time(), due_topics);
+
+	for (const std::string& topic : due_topics) {
+		auto search = topic_providers.find(topic);
+		if (search == topic_providers.end()) {
+			continue;
+		}
+
+		// providers whose target object was freed are unregistered
+		godot::Ref<godot::FuncRef> provider = search->second;
+		if (!provider->is_valid()) {
+			if (verbosity >= WARNING) {
+				std::cerr << "Godot-AI-Bridge: state provider no longer valid, unregistering topic " << topic << std::endl;
+			}
+
+			scheduler.remove_topic(topic);
+			topic_providers.erase(search);
+			continue;
+		}
+
+		// without credit the provider is not called (no state is produced that consumers have no room for)
+		if (!flow.has_credit(topic)) {
+			report_backpressure(topic, PUBLISH_DROPPED);
+			continue;
+		}
+
+		godot::Variant state = provider->call_funcv(godot::Array());
+
+		// only delivered messages count toward the bandwidth budget and message size estimate
+		size_t n_bytes = 0;
+		if (publish(topic, state, n_bytes) == PUBLISH_SENT) {
+			scheduler.record_published(topic, n_bytes);
+		}
+	}
 }
 
+
 // Maps socket options from Godot Dictionary to a std::map usable by ZeroMQ
-void gab::map_options(const godot::Dictionary& v_options, std::map<int, int>& options_out)
+void gab::map_options(const godot::Dictionary& v_options, std::map<int, int>& options_out, bool is_publisher)
 {
 	// Map from Godot's String options to ZMQ options. The keys in this map are the complete list of connection options available from Godot.
 	static std::map<godot::String, int> GODOT_OPTION_TO_ZMQ_MAP = {
@@ -328,6 +631,12 @@ void gab::map_options(const godot::Dictionary& v_options, std::map<int, int>& op
 		{godot::String("ZMQ_SNDHWM"), ZMQ_SNDHWM},
 		{godot::String("ZMQ_SNDTIMEO"), ZMQ_SNDTIMEO},
 		{godot::String("ZMQ_CONFLATE"), ZMQ_CONFLATE},
+		{godot::String("ZMQ_XPUB_NODROP"), ZMQ_XPUB_NODROP},
+	};
+
+	// options that only apply to the publisher socket
+	static std::set<int> PUBLISHER_ONLY_OPTIONS = {
+		ZMQ_XPUB_NODROP,
 	};
 
 	// iterate over Godot dictionary keys
@@ -340,9 +649,78 @@ void gab::map_options(const godot::Dictionary& v_options, std::map<int, int>& op
 		auto search = GODOT_OPTION_TO_ZMQ_MAP.find(key);
 		if (search != GODOT_OPTION_TO_ZMQ_MAP.end()) {
 			int zmq_option = search->second;
+			if (!is_publisher && PUBLISHER_ONLY_OPTIONS.count(zmq_option) > 0) {
+				continue;
+			}
+
 			int zmq_value = (int)convert_int(v_options[key]);
 
 			options_out[zmq_option] = zmq_value;
 		}
 	}
 }
+
+// Maps the "performance" section of connect's options from a Godot Dictionary
+void gab::map_performance_options(const godot::Dictionary& v_options, PerformanceOptions& options_out)
+{
+	static const godot::String IO_THREADS = "io_threads";
+	static const godot::String IO_THREAD_CPUS = "io_thread_cpus";
+	static const godot::String IO_THREAD_PRIORITY = "io_thread_priority";
+	static const godot::String LISTENER_CPU = "listener_cpu";
+	static const godot::String LISTENER_PRIORITY = "listener_priority";
+	static const godot::String BUSY_POLL_US = "busy_poll_us";
+
+	if (v_options.has(IO_THREADS)) {
+		options_out.io_threads = (int)convert_int(v_options[IO_THREADS]);
+	}
+
+	if (v_options.has(IO_THREAD_CPUS)) {
+		godot::Array cpus = v_options[IO_THREAD_CPUS];
+
+		options_out.io_thread_cpus.clear();
+		for (int i = 0; i < cpus.size(); i++) {
+			options_out.io_thread_cpus.push_back((int)convert_int(cpus[i]));
+		}
+	}
+
+	if (v_options.has(IO_THREAD_PRIORITY)) {
+		options_out.io_thread_priority = (int)convert_int(v_options[IO_THREAD_PRIORITY]);
+	}
+
+	if (v_options.has(LISTENER_CPU)) {
+		options_out.listener_cpu = (int)convert_int(v_options[LISTENER_CPU]);
+	}
+
+	if (v_options.has(LISTENER_PRIORITY)) {
+		options_out.listener_priority = (int)convert_int(v_options[LISTENER_PRIORITY]);
+	}
+
+	if (v_options.has(BUSY_POLL_US)) {
+		options_out.busy_poll_us = (int)std::max<int64_t>(convert_int(v_options[BUSY_POLL_US]), 0);
+	}
+}
+
+// Maps the "flow_control" section of connect's options from a Godot Dictionary
+void gab::map_flow_control_options(const godot::Dictionary& v_options, FlowControlOptions& options_out)
+{
+	static const godot::String CREDIT = "credit";
+	static const godot::String INITIAL_CREDIT = "initial_credit";
+	static const godot::String MAX_CREDIT = "max_credit";
+	static const godot::String BACKPRESSURE_THRESHOLD = "backpressure_threshold";
+
+	if (v_options.has(CREDIT)) {
+		options_out.is_credit_enabled = convert_bool(v_options[CREDIT]);
+	}
+
+	if (v_options.has(INITIAL_CREDIT)) {
+		options_out.initial_credit = std::max<int64_t>(convert_int(v_options[INITIAL_CREDIT]), 0);
+	}
+
+	if (v_options.has(MAX_CREDIT)) {
+		options_out.max_credit = std::max<int64_t>(convert_int(v_options[MAX_CREDIT]), 1);
+	}
+
+	if (v_options.has(BACKPRESSURE_THRESHOLD)) {
+		options_out.backpressure_threshold = (int)std::max<int64_t>(convert_int(v_options[BACKPRESSURE_THRESHOLD]), 1);
+	}
+}
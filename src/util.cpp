@@ -2,6 +2,8 @@
 
 using json = nlohmann::json;
 
+using namespace gab;
+
 // this may need to change if Godot's character encoding scheme changes
 using convert_type = std::codecvt_utf8<wchar_t>;
 
@@ -12,203 +14,199 @@ std::string gab::convert_string(const godot::String& v) {
 	return converter.to_bytes(v.unicode_str());
 }
 
-void gab::marshal_basic_variant(const godot::Variant& value, nlohmann::json& marshaler) {
+static void visit_variant(const godot::Variant& value, ValueVisitor& visitor, bool is_array_element);
 
-	switch (value.get_type()) {
-	case godot::Variant::NIL:
-		marshaler = convert_nil(value);
-		break;
-	case godot::Variant::BOOL:
-		marshaler = convert_bool(value);
-		break;
-	case godot::Variant::INT:
-		marshaler = convert_int(value);
-		break;
-	case godot::Variant::REAL:
-		marshaler = convert_real(value);
-		break;
-	case godot::Variant::STRING:
-		marshaler = convert_string(value);
-		break;
-	default:
-		// TODO: Replace with an exception?
-		std::cerr << "Unrecognized variant type: " << value.get_type() << std::endl;
-		break;
+template <class PoolArray>
+static void visit_pool_elements(PoolArray array, ValueVisitor& visitor) {
+	visitor.begin_array(array.size());
+	for (int i = 0; i < array.size(); i++) {
+		visit_variant(array[i], visitor, true);
 	}
+	visitor.end_array();
 }
 
-void gab::marshal_basic_variant_in_array(const godot::Variant& value, nlohmann::json& marshaler) {
+static void visit_variant(const godot::Variant& value, ValueVisitor& visitor, bool is_array_element) {
 
 	switch (value.get_type()) {
 	case godot::Variant::NIL:
-		marshaler.push_back(convert_nil(value));
+		visitor.visit_nil();
 		break;
 	case godot::Variant::BOOL:
-		marshaler.push_back(convert_bool(value));
+		visitor.visit_bool(convert_bool(value));
 		break;
 	case godot::Variant::INT:
-		marshaler.push_back(convert_int(value));
+		visitor.visit_int(convert_int(value));
 		break;
 	case godot::Variant::REAL:
-		marshaler.push_back(convert_real(value));
+		visitor.visit_real(convert_real(value));
 		break;
 	case godot::Variant::STRING:
-		marshaler.push_back(convert_string(value));
+		visitor.visit_string(convert_string(value));
 		break;
-	default:
-		GodotAiBridgeException("unrecognized variant type: " + std::to_string(value.get_type()));
-	}
-}
-
-void gab::marshal_array_variant(const godot::Array& array, nlohmann::json& marshaler) {
-	for (int i = 0; i < array.size(); i++) {
-		godot::Variant value = array[i];
+	case godot::Variant::DICTIONARY:
+	{
+		godot::Dictionary dict = value;
+		godot::Array keys = dict.keys();
 
-		if (is_basic_variant(value)) {
-			marshal_basic_variant_in_array(value, marshaler);
-		}
-		else if (is_array_variant(value)) {
-			// adds empty array
-			marshaler.push_back(json::array());
+		visitor.begin_dictionary(keys.size());
+		for (int i = 0; i < keys.size(); i++)
+		{
+			godot::Variant key = keys[i];
 
-			// recusrive call
-			marshal_array_variant(value, marshaler[marshaler.size() - 1]);
-		}
-		else if (is_dictionary_variant(value)) {
-			// adds empty dictionary
-			marshaler.push_back(json({}));
-			
-			marshal_dictionary_variant(value, marshaler[marshaler.size() - 1]);
+			visitor.visit_key(convert_string(key));
+			visit_variant(dict[key], visitor, false);
 		}
+		visitor.end_dictionary();
+		break;
 	}
-}
-
-void gab::marshal_dictionary_variant(const godot::Dictionary& dict, nlohmann::json& marshaler) {
-
-	godot::Array keys = dict.keys();
-
-	for (int i = 0; i < keys.size(); i++)
+	case godot::Variant::ARRAY:
 	{
-		godot::Variant key = keys[i];
-		godot::Variant value = dict[key];
+		godot::Array array = value;
 
-		json& element = marshaler[convert_string(key)];
-		marshal_variant(value, element);
+		visitor.begin_array(array.size());
+		for (int i = 0; i < array.size(); i++) {
+			visit_variant(array[i], visitor, true);
+		}
+		visitor.end_array();
+		break;
 	}
-}
-
-void gab::marshal_pool_variant(const godot::Variant& array, nlohmann::json& marshaler)
-{
-	marshal_array_variant(array, marshaler);
-}
-
-void gab::marshal_variant(const godot::Variant& value, nlohmann::json& marshaler) {
-
-	switch (value.get_type()) {
-	case godot::Variant::DICTIONARY:
+	case godot::Variant::POOL_INT_ARRAY:
 	{
-		marshal_dictionary_variant(value, marshaler);
+		godot::PoolIntArray array = value;
+		godot::PoolIntArray::Read r = array.read();
+
+		visitor.visit_int_array(r.ptr(), array.size());
 		break;
 	}
-	case godot::Variant::ARRAY:
+	case godot::Variant::POOL_REAL_ARRAY:
 	{
-		marshal_array_variant(value, marshaler);
+		godot::PoolRealArray array = value;
+		godot::PoolRealArray::Read r = array.read();
+
+		visitor.visit_real_array(r.ptr(), array.size());
 		break;
 	}
-	case godot::Variant::NIL:
-	case godot::Variant::BOOL:
-	case godot::Variant::INT:
-	case godot::Variant::REAL:
-	case godot::Variant::STRING:
+	case godot::Variant::POOL_BYTE_ARRAY:
 	{
-		marshal_basic_variant(value, marshaler);
+		godot::PoolByteArray array = value;
+		godot::PoolByteArray::Read r = array.read();
+
+		visitor.visit_byte_array(r.ptr(), array.size());
 		break;
 	}
-	case godot::Variant::POOL_BYTE_ARRAY:
-	case godot::Variant::POOL_INT_ARRAY:
-	case godot::Variant::POOL_REAL_ARRAY:
 	case godot::Variant::POOL_STRING_ARRAY:
+		visit_pool_elements(godot::PoolStringArray(value), visitor);
+		break;
 	case godot::Variant::POOL_VECTOR2_ARRAY:
+		visit_pool_elements(godot::PoolVector2Array(value), visitor);
+		break;
 	case godot::Variant::POOL_VECTOR3_ARRAY:
+		visit_pool_elements(godot::PoolVector3Array(value), visitor);
+		break;
 	case godot::Variant::POOL_COLOR_ARRAY:
-	{
-		marshal_pool_variant(value, marshaler);
+		visit_pool_elements(godot::PoolColorArray(value), visitor);
 		break;
-	}
 	default:
-		throw GodotAiBridgeException("unrecognized variant type: " + std::to_string(value.get_type()));
+		// unsupported array elements are skipped
+		if (!is_array_element) {
+			throw GodotAiBridgeException("unrecognized variant type: " + std::to_string(value.get_type()));
+		}
 	}
 }
 
-godot::Variant gab::unmarshal_to_variant(nlohmann::json& value) {
-	godot::Variant v(0);
-	if (value.is_primitive()) {
-		v = unmarshal_to_basic_variant(value);
-	}
-	else if (value.is_structured()) {
-		v = unmarshal_to_structured_variant(value);
-	}
-	else {
-		throw GodotAiBridgeException("unmarshal failed (reason: unknown variant type). value = " + std::string(value));
-	}
-	return v;
+void gab::marshal_variant(const godot::Variant& value, nlohmann::json& marshaler) {
+	encode_value(VariantValue(value), marshaler);
 }
 
-godot::Variant gab::unmarshal_to_basic_variant(nlohmann::json& value) {
-	if (value.is_string()) {
-		return unmarshal_to_string_variant(value);
-	}
-	else if (value.is_null()) {
-		return unmarshal_to_nil_variant(value);
-	}
-	else if (value.is_number_integer()) {
-		return unmarshal_to_int_variant(value);
-	}
-	else if (value.is_number_float()) {
-		return unmarshal_to_real_variant(value);
-	}
-	else if (value.is_boolean()) {
-		return unmarshal_to_bool_variant(value);
-	}
-	else {
-		throw GodotAiBridgeException("unmarshal failed (reason: unknown variant type). value = " + std::string(value));
-	}
+godot::Variant gab::unmarshal_to_variant(const nlohmann::json& value, ArrayHint hint) {
+	VariantBuilder builder;
+	decode_json(value, builder, hint);
+
+	return builder.get_result();
 }
 
-godot::Variant gab::unmarshal_to_structured_variant(nlohmann::json& value) {
-	godot::Variant v(0);
-	if (value.is_array()) {
-		v = unmarshal_to_array_variant(value);
-	}
-	else if (value.is_object()) {
-		v = unmarshal_to_dictionary_variant(value);
-	}
-	else {
-		throw GodotAiBridgeException("unmarshal failed (reason: unknown variant type). value = " + std::string(value));
-	}
-	return v;
+
+/* Implementation of VariantValue Class
+ ***************************************/
+VariantValue::VariantValue(const godot::Variant& value)
+	: value(value)
+{
+
 }
 
-godot::Variant gab::unmarshal_to_array_variant(nlohmann::json& value) {
-	godot::Array array;
-	for (json::iterator it = value.begin(); it != value.end(); ++it) {
-		array.push_back(unmarshal_to_variant(*it));
+void VariantValue::accept(ValueVisitor& visitor) const
+{
+	visit_variant(value, visitor, false);
+}
+
+
+/* Implementation of VariantBuilder Class
+ *****************************************/
+// JSON null is unmarshaled as 0 (not NIL), as it always has been
+void VariantBuilder::visit_nil()
+{
+	add(godot::Variant(0));
+}
+
+void VariantBuilder::visit_bool(bool v)
+{
+	add(godot::Variant(v));
+}
+
+void VariantBuilder::visit_int(int64_t v)
+{
+	add(godot::Variant(v));
+}
+
+void VariantBuilder::visit_real(double v)
+{
+	add(godot::Variant(v));
+}
+
+void VariantBuilder::visit_string(const std::string& v)
+{
+	add(godot::Variant(v.c_str()));
+}
+
+// the pool array builders presize the array and fill it through a single write lock
+void VariantBuilder::visit_int_array(const int32_t* p_elements, size_t size)
+{
+	godot::PoolIntArray array;
+	array.resize((int)size);
+
+	if (size > 0) {
+		godot::PoolIntArray::Write w = array.write();
+		memcpy(w.ptr(), p_elements, size * sizeof(int32_t));
 	}
 
-	return array;
+	add(array);
 }
 
-godot::Variant gab::unmarshal_to_dictionary_variant(nlohmann::json& value) {
-	godot::Dictionary dict;
-	for (auto& kv_pair : value.items()) {
-		auto k = kv_pair.key();
-		auto v = kv_pair.value();
+void VariantBuilder::visit_real_array(const float* p_elements, size_t size)
+{
+	godot::PoolRealArray array;
+	array.resize((int)size);
+
+	if (size > 0) {
+		godot::PoolRealArray::Write w = array.write();
+		real_t* p_element = w.ptr();
+		for (size_t i = 0; i < size; i++) {
+			p_element[i] = real_t(p_elements[i]);
+		}
+	}
 
-		godot::Variant v_key(std::string(k).c_str());
-		godot::Variant v_value(unmarshal_to_variant(v));
+	add(array);
+}
+
+void VariantBuilder::visit_byte_array(const uint8_t* p_elements, size_t size)
+{
+	godot::PoolByteArray array;
+	array.resize((int)size);
 
-		dict[v_key] = v_value;
+	if (size > 0) {
+		godot::PoolByteArray::Write w = array.write();
+		memcpy(w.ptr(), p_elements, size);
 	}
 
-	return dict;
+	add(array);
 }
@@ -0,0 +1,41 @@
+/* Godot-AI-Bridge (GAB) - Core Unit Tests
+*
+*  Description: Runs the unit tests of the engine-independent core (codec, flow control, scheduler and protocol helpers). Built with
+*               the SConstruct "core" target; exits with a non-zero status if any check fails.
+*
+*  Usage: gab_core_tests [name_filter]
+*****************************************************************************************************************************************/
+#include <string>
+
+#include "test.h"
+
+int main(int argc, char** argv)
+{
+	std::string filter = (argc > 1) ? argv[1] : "";
+
+	int n_run = 0;
+	for (const gab_test::TestCase& test_case : gab_test::get_test_cases()) {
+		if (!filter.empty() && std::string(test_case.name).find(filter) == std::string::npos) {
+			continue;
+		}
+
+		int n_failures = gab_test::get_failure_count();
+
+		try {
+			test_case.run();
+		}
+		catch (const gab_test::TestAborted&) {
+		}
+		catch (const std::exception& e) {
+			gab_test::get_failure_count()++;
+			std::cerr << test_case.name << ": unexpected exception -> " << e.what() << std::endl;
+		}
+
+		std::cout << ((gab_test::get_failure_count() == n_failures) ? "[ ok ] " : "[FAIL] ") << test_case.name << std::endl;
+		n_run++;
+	}
+
+	std::cout << n_run << " tests run, " << gab_test::get_failure_count() << " checks failed" << std::endl;
+
+	return (gab_test::get_failure_count() == 0) ? 0 : 1;
+}
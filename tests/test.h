@@ -0,0 +1,73 @@
+/* Godot-AI-Bridge (GAB) - Core Unit Tests
+*
+*  Description: A minimal test harness for the engine-independent core (no external test framework). Test cases register themselves
+*               with GAB_TEST; CHECK records a failure and continues, REQUIRE ends the test case. Tests run from tests/main.cpp.
+*****************************************************************************************************************************************/
+#pragma once
+
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace gab_test {
+
+	struct TestCase {
+		const char* name;
+		std::function<void()> run;
+	};
+
+	// thrown by REQUIRE to end the current test case
+	struct TestAborted {};
+
+	inline std::vector<TestCase>& get_test_cases()
+	{
+		static std::vector<TestCase> test_cases;
+		return test_cases;
+	}
+
+	inline int& get_failure_count()
+	{
+		static int n_failures = 0;
+		return n_failures;
+	}
+
+	struct TestRegistrar {
+		TestRegistrar(const char* name, std::function<void()> run) {
+			get_test_cases().push_back(TestCase{ name, run });
+		}
+	};
+
+	inline bool report(bool is_passed, const char* expression, const char* file, int line)
+	{
+		if (!is_passed) {
+			get_failure_count()++;
+			std::cerr << file << ":" << line << ": check failed -> " << expression << std::endl;
+		}
+
+		return is_passed;
+	}
+};
+
+#define GAB_TEST_CONCAT_IMPL(a, b) a##b
+#define GAB_TEST_CONCAT(a, b) GAB_TEST_CONCAT_IMPL(a, b)
+
+#define GAB_TEST(name) \
+	static void GAB_TEST_CONCAT(test_, name)(); \
+	static gab_test::TestRegistrar GAB_TEST_CONCAT(registrar_, name)(#name, &GAB_TEST_CONCAT(test_, name)); \
+	static void GAB_TEST_CONCAT(test_, name)()
+
+#define CHECK(expression) gab_test::report(bool(expression), #expression, __FILE__, __LINE__)
+
+#define REQUIRE(expression) do { if (!CHECK(expression)) { throw gab_test::TestAborted(); } } while (0)
+
+// checks that statement throws an exception of the given type
+#define CHECK_THROWS(statement, exception_type) \
+	do { \
+		bool is_thrown = false; \
+		try { statement; } \
+		catch (const exception_type&) { is_thrown = true; } \
+		catch (...) {} \
+		gab_test::report(is_thrown, #statement " throws " #exception_type, __FILE__, __LINE__); \
+	} while (0)
@@ -0,0 +1,82 @@
+#include <thread>
+
+#include "test.h"
+#include "gab_client.h"
+#include "transport.h"
+
+using namespace gab;
+
+static const uint16_t TEST_CLIENT_LISTENER_PORT = 21112;
+static const int TEST_CLIENT_TIMEOUT = 2000;  // in milliseconds
+
+/* RejectingHandler Class
+*
+*  Description: A RequestHandler that rejects events whose value is "bad" (so tests can tell replies apart).
+*****************************************************************************************************************************************/
+class RejectingHandler : public RequestHandler {
+public:
+	void notify(json& request, std::string& parse_errors) override {
+		if (request[MSG_DATA][EVENT].value("value", "") == "bad") {
+			parse_errors = "bad event";
+		}
+	}
+
+	void notify_batch(json& request, std::vector<std::string>& event_errors) override {
+		for (const json& event : request[MSG_DATA][EVENTS]) {
+			event_errors.push_back((event.value("value", "") == "bad") ? "bad event" : "");
+		}
+	}
+
+	std::shared_ptr<const std::string> get_snapshot(const std::string& topic) const override { return nullptr; }
+	int64_t grant_credit(const std::string& topic, int64_t n) override { return n; }
+	uint64_t get_epoch() const override { return 0; }
+};
+
+GAB_TEST(client_pipelined_sender_keeps_replies_read_while_waiting)
+{
+	zmq::context_t context;
+	RejectingHandler handler;
+
+	Listener listener(context, DEFAULT_LISTENER_OPTIONS, TEST_CLIENT_LISTENER_PORT, handler);
+	std::thread listener_thread(std::ref(listener));
+
+	{
+		ActionSender sender(context, "127.0.0.1", TEST_CLIENT_LISTENER_PORT, 1);
+
+		// with a pipeline depth of 1, each send has to read the previous reply first
+		uint64_t bad_seqno = sender.send_event(json{ {"value", "bad"} }, TEST_CLIENT_TIMEOUT);
+		uint64_t batch_seqno = sender.send_events(json::array({ json{ {"value", "good"} }, json{ {"value", "bad"} } }), TEST_CLIENT_TIMEOUT);
+		uint64_t good_seqno = sender.send_event(json{ {"value", "good"} }, TEST_CLIENT_TIMEOUT);
+
+		CHECK(sender.get_received() == 2);
+		CHECK(sender.get_in_flight() == 1);
+
+		json reply;
+		uint64_t seqno = 0;
+
+		REQUIRE(sender.receive(reply, seqno, TEST_CLIENT_TIMEOUT));
+		CHECK(seqno == bad_seqno);
+		CHECK(reply[MSG_DATA][REPLY_STATUS] == STATUS_ERROR);
+
+		REQUIRE(sender.receive(reply, seqno, TEST_CLIENT_TIMEOUT));
+		CHECK(seqno == batch_seqno);
+		CHECK(reply[MSG_DATA][REPLY_RESULTS].size() == 2);
+		CHECK(reply[MSG_DATA][REPLY_RESULTS][1][REPLY_STATUS] == STATUS_ERROR);
+
+		REQUIRE(sender.receive(reply, seqno, TEST_CLIENT_TIMEOUT));
+		CHECK(seqno == good_seqno);
+		CHECK(is_success_reply(reply));
+
+		// request returns its own reply, and keeps the replies of older requests
+		sender.send_event(json{ {"value", "bad"} }, TEST_CLIENT_TIMEOUT);
+		CHECK(is_success_reply(sender.request(json{ {EVENT, json{ {"value", "good"} }} }, TEST_CLIENT_TIMEOUT)));
+		CHECK(sender.get_received() == 1);
+
+		sender.discard_received();
+		CHECK(sender.get_received() == 0);
+		CHECK_THROWS(sender.receive(reply, seqno, 0), GodotAiBridgeException);
+	}
+
+	listener.stop();
+	listener_thread.join();
+}
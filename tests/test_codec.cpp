@@ -0,0 +1,224 @@
+#include <limits>
+
+#include "test.h"
+#include "codec.h"
+
+using namespace gab;
+
+using json = nlohmann::json;
+
+/* TraceVisitor Class
+*
+*  Description: A ValueVisitor that records what it visits as a compact trace (e.g., "{a:i1,b:[r2.5]}" or "I[1,2]" for an int
+*               array), so tests can compare how a document was described.
+*****************************************************************************************************************************************/
+class TraceVisitor : public ValueVisitor {
+private:
+	std::vector<bool> needs_separator;  // by open container (innermost last)
+
+	void separate() {
+		if (!needs_separator.empty()) {
+			if (needs_separator.back()) {
+				trace << ",";
+			}
+			needs_separator.back() = true;
+		}
+	}
+
+	template <typename T>
+	void visit_elements(char type, const T* p_elements, size_t size) {
+		separate();
+		trace << type << "[";
+		for (size_t i = 0; i < size; i++) {
+			trace << ((i > 0) ? "," : "") << +p_elements[i];
+		}
+		trace << "]";
+	}
+
+public:
+	std::ostringstream trace;
+
+	void visit_nil() override { separate(); trace << "n"; }
+	void visit_bool(bool v) override { separate(); trace << (v ? "t" : "f"); }
+	void visit_int(int64_t v) override { separate(); trace << "i" << v; }
+	void visit_real(double v) override { separate(); trace << "r" << v; }
+	void visit_string(const std::string& v) override { separate(); trace << "s" << v; }
+
+	void begin_array(size_t size) override { separate(); trace << "["; needs_separator.push_back(false); }
+	void end_array() override { needs_separator.pop_back(); trace << "]"; }
+
+	// keys are written by visit_key, so the value that follows must not add a separator of its own
+	void begin_dictionary(size_t size) override { separate(); trace << "{"; needs_separator.push_back(false); }
+	void visit_key(const std::string& key) override { separate(); trace << key << ":"; needs_separator.back() = false; }
+	void end_dictionary() override { needs_separator.pop_back(); trace << "}"; }
+
+	void visit_int_array(const int32_t* p_elements, size_t size) override { visit_elements('I', p_elements, size); }
+	void visit_real_array(const float* p_elements, size_t size) override { visit_elements('R', p_elements, size); }
+	void visit_byte_array(const uint8_t* p_elements, size_t size) override { visit_elements('B', p_elements, size); }
+};
+
+/* JsonBuilder Class
+*
+*  Description: A ContainerBuilder that rebuilds a JSON document (assembles containers exactly as the Godot Variant builder does).
+*               Typed arrays become plain JSON arrays.
+*****************************************************************************************************************************************/
+class JsonBuilder : public ContainerBuilder<json, json::array_t, json::object_t, std::string> {
+private:
+	template <typename T>
+	void add_elements(const T* p_elements, size_t size) {
+		add(json(std::vector<T>(p_elements, p_elements + size)));
+	}
+
+public:
+	void visit_nil() override { add(json(nullptr)); }
+	void visit_bool(bool v) override { add(json(v)); }
+	void visit_int(int64_t v) override { add(json(v)); }
+	void visit_real(double v) override { add(json(v)); }
+	void visit_string(const std::string& v) override { add(json(v)); }
+
+	void visit_int_array(const int32_t* p_elements, size_t size) override { add_elements(p_elements, size); }
+	void visit_real_array(const float* p_elements, size_t size) override { add_elements(p_elements, size); }
+	void visit_byte_array(const uint8_t* p_elements, size_t size) override { add_elements(p_elements, size); }
+};
+
+static json build_json(const json& value, ArrayHint hint = ARRAY_HINT_AUTO)
+{
+	JsonBuilder builder;
+	decode_json(value, builder, hint);
+
+	return builder.get_result();
+}
+
+static std::string trace_json(const json& value, ArrayHint hint = ARRAY_HINT_AUTO)
+{
+	TraceVisitor visitor;
+	decode_json(value, visitor, hint);
+
+	return visitor.trace.str();
+}
+
+static json round_trip(const json& value, ArrayHint hint = ARRAY_HINT_AUTO)
+{
+	json marshaler;
+	encode_value(JsonValue(value, hint), marshaler);
+
+	return marshaler;
+}
+
+GAB_TEST(codec_round_trips_scalars_and_containers)
+{
+	json value = json::parse(R"({"nil": null, "flag": true, "count": -7, "ratio": 0.25, "name": "agent 1",
+		"nested": {"inner": {"depth": 2}, "list": [1, "two", 3.5, [false]]}, "empty_list": [], "empty_dict": {}})");
+
+	CHECK(round_trip(value) == value);
+	CHECK(round_trip(value, ARRAY_HINT_GENERIC) == value);
+}
+
+GAB_TEST(codec_round_trips_typed_arrays)
+{
+	json ints = json::array({ 0, -1, std::numeric_limits<int32_t>::max(), std::numeric_limits<int32_t>::min() });
+	json reals = json::array({ 0.5, -1.25, 3 });
+
+	CHECK(round_trip(ints) == ints);
+	CHECK(round_trip(reals) == reals);
+	CHECK(round_trip(ints, ARRAY_HINT_REAL).at(1) == -1.0);
+	CHECK(round_trip(json::array({ 0, 128, 255 }), ARRAY_HINT_BYTE) == json::array({ 0, 128, 255 }));
+}
+
+GAB_TEST(codec_keeps_nested_dictionary_keys)
+{
+	CHECK(trace_json(json::parse(R"({"a": {"b": 1}, "c": 2})")) == "{a:{b:i1},c:i2}");
+}
+
+GAB_TEST(container_builder_adds_nested_containers_under_their_keys)
+{
+	json nested = json::parse(R"({"a": {"b": {"c": 1}, "d": 2}, "e": [{"f": [3, {"g": null}]}, {}], "h": {"i": []}, "j": "k"})");
+	CHECK(build_json(nested, ARRAY_HINT_GENERIC) == nested);
+
+	CHECK(build_json(json::array({ json::object(), json::array(), 1 })) == json::array({ json::object(), json::array(), 1 }));
+	CHECK(build_json(json::parse(R"({"a": [1, 2], "b": [0.5, 1]})")) == json::parse(R"({"a": [1, 2], "b": [0.5, 1.0]})"));
+	CHECK(build_json(json("top")) == json("top"));
+}
+
+GAB_TEST(codec_auto_hint_selects_typed_arrays)
+{
+	CHECK(trace_json(json::array({ 1, 2, 3 })) == "I[1,2,3]");
+	CHECK(trace_json(json::array({ 1, 2.5 })) == "R[1,2.5]");
+	CHECK(trace_json(json::array({ 1, "x" })) == "[i1,sx]");
+	CHECK(trace_json(json::array()) == "[]");
+
+	// ints that do not fit in 32 bits are kept exact in a generic array
+	CHECK(trace_json(json::array({ 1, int64_t(1) << 40 })) == "[i1,i1099511627776]");
+}
+
+GAB_TEST(codec_auto_hint_keeps_reals_that_floats_would_alter)
+{
+	// decimals within float precision still become typed real arrays
+	CHECK(trace_json(json::array({ 0.1, 0.2, -3.25 })) == "R[0.1,0.2,-3.25]");
+
+	CHECK(trace_json(json::array({ 0.5, 123456789 })) == "[r0.5,i123456789]");
+	CHECK(trace_json(json::array({ 0.5, 0.123456789 })) == "[r0.5,r0.123457]");
+	CHECK(trace_json(json::array({ 0.5, 1e300 })).substr(0, 1) == "[");
+	CHECK(round_trip(json::array({ 0.5, 0.123456789 })) == json::array({ 0.5, 0.123456789 }));
+}
+
+GAB_TEST(codec_detects_float_representable_values)
+{
+	CHECK(is_float_representable(0.0));
+	CHECK(is_float_representable(0.1));
+	CHECK(is_float_representable(1234567.0));
+	CHECK(is_float_representable(16777216.0));
+	CHECK(!is_float_representable(16777217.0));
+	CHECK(!is_float_representable(0.123456789));
+	CHECK(!is_float_representable(1e39));
+}
+
+GAB_TEST(codec_generic_hint_disables_typed_arrays)
+{
+	CHECK(trace_json(json::array({ 1, 2.5 }), ARRAY_HINT_GENERIC) == "[i1,r2.5]");
+}
+
+GAB_TEST(codec_forced_hints_convert_numeric_arrays)
+{
+	CHECK(trace_json(json::array({ 1, 2 }), ARRAY_HINT_REAL) == "R[1,2]");
+	CHECK(trace_json(json::array({ 0.5, 123456789 }), ARRAY_HINT_REAL) == "R[0.5,1.23457e+08]");
+	CHECK(trace_json(json::array({ 1.0, 2.0 }), ARRAY_HINT_INT) == "I[1,2]");
+	CHECK(trace_json(json::array({ 0, 255 }), ARRAY_HINT_BYTE) == "B[0,255]");
+
+	// non-numeric arrays are unaffected by forced hints
+	CHECK(trace_json(json::array({ "a", 1 }), ARRAY_HINT_INT) == "[sa,i1]");
+}
+
+GAB_TEST(codec_forced_hints_reject_unrepresentable_elements)
+{
+	CHECK_THROWS(trace_json(json::array({ 1, 2.5 }), ARRAY_HINT_INT), GodotAiBridgeException);
+	CHECK_THROWS(trace_json(json::array({ int64_t(1) << 31 }), ARRAY_HINT_INT), GodotAiBridgeException);
+	CHECK_THROWS(trace_json(json::array({ 1e12 }), ARRAY_HINT_INT), GodotAiBridgeException);
+	CHECK_THROWS(trace_json(json::array({ 256 }), ARRAY_HINT_BYTE), GodotAiBridgeException);
+	CHECK_THROWS(trace_json(json::array({ -1 }), ARRAY_HINT_BYTE), GodotAiBridgeException);
+	CHECK_THROWS(trace_json(json::array({ 0.5 }), ARRAY_HINT_BYTE), GodotAiBridgeException);
+	CHECK_THROWS(trace_json(json::array({ 0.5, 1e39 }), ARRAY_HINT_REAL), GodotAiBridgeException);
+}
+
+GAB_TEST(codec_decodes_large_unsigned_as_real)
+{
+	uint64_t large = uint64_t(std::numeric_limits<int64_t>::max()) + 1;
+
+	CHECK(trace_json(json(uint64_t(std::numeric_limits<int64_t>::max()))) == "i9223372036854775807");
+	CHECK(trace_json(json(large)).substr(0, 1) == "r");
+	CHECK(round_trip(json(large)).get<double>() == double(large));
+}
+
+// binary values only occur in documents built in-process (requests received by the listener are text JSON)
+GAB_TEST(codec_decodes_binary_as_byte_array)
+{
+	CHECK(trace_json(json::binary({ 1, 2, 255 })) == "B[1,2,255]");
+}
+
+GAB_TEST(codec_reads_array_hint_from_header)
+{
+	CHECK(get_array_hint(json::parse(R"({"header": {"array_hint": "byte"}})")) == ARRAY_HINT_BYTE);
+	CHECK(get_array_hint(json::parse(R"({"header": {}})")) == ARRAY_HINT_AUTO);
+	CHECK_THROWS(get_array_hint(json::parse(R"({"header": {"array_hint": "bogus"}})")), GodotAiBridgeException);
+	CHECK_THROWS(get_array_hint(json::parse(R"({"header": {"array_hint": 1}})")), GodotAiBridgeException);
+}
@@ -0,0 +1,166 @@
+#include "test.h"
+#include "flow.h"
+
+using namespace gab;
+
+using json = nlohmann::json;
+
+static FlowControlOptions create_credit_options(int64_t initial_credit, int64_t max_credit = DEFAULT_MAX_CREDIT)
+{
+	FlowControlOptions options;
+	options.is_credit_enabled = true;
+	options.initial_credit = initial_credit;
+	options.max_credit = max_credit;
+
+	return options;
+}
+
+GAB_TEST(flow_without_credit_mode_always_acquires)
+{
+	FlowController flow;
+	CreditSource source;
+
+	CHECK(!flow.is_credit_enabled());
+	CHECK(flow.has_credit("a"));
+	CHECK(flow.try_acquire("a", source));
+	CHECK(source == CREDIT_NONE);
+	CHECK_THROWS(flow.grant("a", 1), GodotAiBridgeException);
+}
+
+GAB_TEST(flow_consumes_initial_shared_credit)
+{
+	FlowController flow;
+	CreditSource source;
+	flow.configure(create_credit_options(2));
+
+	CHECK(flow.try_acquire("a", source));
+	CHECK(flow.try_acquire("b", source));
+	CHECK(!flow.has_credit("a"));
+	CHECK(!flow.try_acquire("a", source));
+}
+
+GAB_TEST(flow_uses_topic_credit_before_shared_credit)
+{
+	FlowController flow;
+	CreditSource source;
+	flow.configure(create_credit_options(1));
+
+	CHECK(flow.grant("a", 1) == 1);
+	CHECK(flow.try_acquire("a", source));
+	CHECK(source == CREDIT_TOPIC);
+
+	// the shared credit is still available to other topics
+	CHECK(flow.try_acquire("b", source));
+	CHECK(source == CREDIT_SHARED);
+	CHECK(!flow.try_acquire("a", source));
+	CHECK(!flow.try_acquire("b", source));
+}
+
+GAB_TEST(flow_returns_released_credit_to_its_pool)
+{
+	FlowController flow;
+	flow.configure(create_credit_options(1));
+	flow.grant("a", 1);
+
+	CreditSource topic_source;
+	CreditSource shared_source;
+	REQUIRE(flow.try_acquire("a", topic_source));
+	REQUIRE(flow.try_acquire("a", shared_source));
+	CHECK(topic_source == CREDIT_TOPIC);
+	CHECK(shared_source == CREDIT_SHARED);
+
+	// shared credit returned by topic "a" can be used by topic "b" again
+	flow.release("a", shared_source);
+	CreditSource source;
+	CHECK(flow.try_acquire("b", source));
+	CHECK(source == CREDIT_SHARED);
+	CHECK(!flow.try_acquire("b", source));
+
+	// topic credit returns to the topic only
+	flow.release("a", topic_source);
+	CHECK(!flow.try_acquire("b", source));
+	CHECK(flow.try_acquire("a", source));
+	CHECK(source == CREDIT_TOPIC);
+}
+
+GAB_TEST(flow_bounds_granted_credit)
+{
+	FlowController flow;
+	flow.configure(create_credit_options(0, 5));
+
+	CHECK(flow.grant("a", 3) == 3);
+	CHECK(flow.grant("a", 3) == 5);
+	CHECK(flow.grant("", 100) == 5);
+	CHECK_THROWS(flow.grant("a", -1), GodotAiBridgeException);
+}
+
+GAB_TEST(flow_configure_discards_credit_and_held_messages)
+{
+	FlowController flow;
+	CreditSource source;
+	flow.configure(create_credit_options(0));
+
+	flow.grant("a", 3);
+	flow.hold("b", json{ {"v", 1} });
+
+	flow.configure(create_credit_options(0));
+
+	json held;
+	CHECK(!flow.try_acquire("a", source));
+	CHECK(!flow.take_held("b", held));
+}
+
+GAB_TEST(flow_holds_latest_message_per_topic)
+{
+	FlowController flow;
+
+	flow.hold("a", json{ {"v", 1} });
+	flow.hold("a", json{ {"v", 2} });
+	flow.hold("b", json{ {"v", 3} });
+
+	std::vector<std::string> topics;
+	flow.collect_held_topics(topics);
+	CHECK(topics == std::vector<std::string>({ "a", "b" }));
+
+	json held;
+	REQUIRE(flow.take_held("a", held));
+	CHECK(held["v"] == 2);
+	CHECK(!flow.take_held("a", held));
+
+	flow.discard_held("b");
+	CHECK(!flow.take_held("b", held));
+}
+
+GAB_TEST(flow_reports_backpressure_transitions_once)
+{
+	FlowControlOptions options;
+	options.backpressure_threshold = 3;
+
+	FlowController flow;
+	flow.configure(options);
+
+	CHECK(flow.record("a", PUBLISH_DROPPED) == BACKPRESSURE_UNCHANGED);
+	CHECK(flow.record("a", PUBLISH_QUEUED) == BACKPRESSURE_UNCHANGED);
+	CHECK(flow.record("a", PUBLISH_DROPPED) == BACKPRESSURE_STARTED);
+	CHECK(flow.record("a", PUBLISH_DROPPED) == BACKPRESSURE_UNCHANGED);
+	CHECK(flow.get_undelivered("a") == 4);
+	CHECK(flow.get_undelivered("b") == 0);
+
+	// errors are not a sign of consumers falling behind
+	CHECK(flow.record("a", PUBLISH_ERROR) == BACKPRESSURE_UNCHANGED);
+	CHECK(flow.record("b", PUBLISH_ERROR) == BACKPRESSURE_UNCHANGED);
+	CHECK(flow.get_undelivered("a") == 4);
+	CHECK(flow.get_undelivered("b") == 0);
+
+	CHECK(flow.record("a", PUBLISH_SENT) == BACKPRESSURE_ENDED);
+	CHECK(flow.record("a", PUBLISH_SENT) == BACKPRESSURE_UNCHANGED);
+	CHECK(flow.get_undelivered("a") == 0);
+}
+
+GAB_TEST(flow_names_publish_statuses)
+{
+	CHECK(std::string(get_publish_status_name(PUBLISH_SENT)) == "sent");
+	CHECK(std::string(get_publish_status_name(PUBLISH_DROPPED)) == "dropped");
+	CHECK(std::string(get_publish_status_name(PUBLISH_QUEUED)) == "queued");
+	CHECK(std::string(get_publish_status_name(PUBLISH_ERROR)) == "error");
+}
@@ -0,0 +1,28 @@
+#include "test.h"
+#include "protocol.h"
+
+using namespace gab;
+
+GAB_TEST(protocol_validates_topics)
+{
+	validate_topic("/demo/agent/1");
+
+	CHECK_THROWS(validate_topic(""), GodotAiBridgeException);
+	CHECK_THROWS(validate_topic("agent 1"), GodotAiBridgeException);
+}
+
+GAB_TEST(protocol_splits_topic_messages)
+{
+	zmq::message_t message = construct_topic_message("state", "{\"data\": \"a b\"}");
+
+	std::string_view topic;
+	std::string_view payload;
+	split_topic_message(message, topic, payload);
+
+	CHECK(topic == "state");
+	CHECK(payload == "{\"data\": \"a b\"}");
+
+	zmq::message_t malformed(12);
+	memcpy(malformed.data(), "no-separator", 12);
+	CHECK_THROWS(split_topic_message(malformed, topic, payload), GodotAiBridgeException);
+}
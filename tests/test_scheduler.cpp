@@ -0,0 +1,185 @@
+#include <cmath>
+
+#include "test.h"
+#include "scheduler.h"
+
+using namespace gab;
+
+GAB_TEST(scheduler_publishes_at_topic_rate)
+{
+	PublishScheduler scheduler;
+	scheduler.add_topic("a", 10.0, 0, 0.0);
+
+	std::vector<std::string> due;
+	scheduler.collect_due(0.0, due);
+	CHECK(due == std::vector<std::string>({ "a" }));
+
+	scheduler.collect_due(0.05, due);
+	CHECK(due.empty());
+
+	scheduler.collect_due(0.1, due);
+	CHECK(due == std::vector<std::string>({ "a" }));
+
+	// publications missed while falling behind are not made up in a burst
+	scheduler.collect_due(1.0, due);
+	CHECK(due.size() == 1);
+	scheduler.collect_due(1.0, due);
+	CHECK(due.empty());
+}
+
+GAB_TEST(scheduler_staggers_equal_rate_topics)
+{
+	PublishScheduler scheduler;
+	scheduler.add_topic("a", 1.0, 0, 0.0);
+	scheduler.add_topic("b", 1.0, 0, 0.0);
+
+	REQUIRE(scheduler.get_topic("a") != nullptr);
+	REQUIRE(scheduler.get_topic("b") != nullptr);
+	CHECK(scheduler.get_topic("a")->next_due != scheduler.get_topic("b")->next_due);
+	CHECK(scheduler.get_topic("b")->next_due < 1.0);
+}
+
+// largest number of topics due on one frame, for frames at fps from start (inclusive) to end (exclusive)
+static size_t run_frames(PublishScheduler& scheduler, double start, double end, double fps)
+{
+	size_t max_due = 0;
+
+	std::vector<std::string> due;
+	for (double now = start; now < end; now += 1.0 / fps) {
+		scheduler.collect_due(now, due);
+		max_due = std::max(max_due, due.size());
+	}
+
+	return max_due;
+}
+
+GAB_TEST(scheduler_keeps_staggering_after_frame_hitch)
+{
+	PublishScheduler scheduler;
+	for (int i = 0; i < 20; i++) {
+		scheduler.add_topic("topic_" + std::to_string(i), 10.0, 0, 0.0);
+	}
+
+	size_t max_due_before = run_frames(scheduler, 1.0 / 60.0, 2.0, 60.0);
+	CHECK(max_due_before <= 4);
+
+	// a 0.5 second hitch makes every topic late (all are due on the first frame after it)
+	std::vector<std::string> due;
+	scheduler.collect_due(2.5, due);
+	CHECK(due.size() == 20);
+
+	// afterwards the topics are spread across frames as before
+	size_t max_due_after = run_frames(scheduler, 2.5 + 1.0 / 60.0, 5.0, 60.0);
+	CHECK(max_due_after <= max_due_before);
+}
+
+GAB_TEST(scheduler_skipped_topics_keep_their_phase)
+{
+	PublishScheduler scheduler;
+	scheduler.add_topic("a", 1.0, 0, 0.0);
+	scheduler.add_topic("b", 1.0, 0, 0.0);
+
+	double phase_b = scheduler.get_topic("b")->next_due;
+
+	std::vector<std::string> due;
+	scheduler.collect_due(0.0, due);
+	scheduler.record_published("a", 600);
+
+	// "b" is skipped for the bandwidth budget after it becomes due, but stays on its own schedule
+	scheduler.set_bandwidth_limit(100.0);
+	scheduler.record_published("b", 500);
+	scheduler.record_published("a", 100);
+	scheduler.collect_due(phase_b + 0.25, due);
+	CHECK(scheduler.get_topic("b")->n_skipped == 1);
+	CHECK(std::fabs(scheduler.get_topic("b")->next_due - (phase_b + 1.0)) < 1e-9);
+}
+
+GAB_TEST(scheduler_rejects_invalid_rates)
+{
+	PublishScheduler scheduler;
+
+	CHECK_THROWS(scheduler.add_topic("a", 0.0, 0, 0.0), GodotAiBridgeException);
+	CHECK_THROWS(scheduler.add_topic("a", -1.0, 0, 0.0), GodotAiBridgeException);
+	CHECK(scheduler.get_topic("a") == nullptr);
+}
+
+GAB_TEST(scheduler_serves_priorities_first_and_carries_over)
+{
+	PublishScheduler scheduler;
+	scheduler.set_max_topics_per_frame(1);
+	scheduler.add_topic("low", 1.0, 0, 0.0);
+	scheduler.add_topic("high", 1.0, 5, 0.0);
+
+	std::vector<std::string> due;
+	scheduler.collect_due(1.0, due);
+	CHECK(due == std::vector<std::string>({ "high" }));
+
+	// the topic that did not fit is published on the next frame
+	scheduler.collect_due(1.0, due);
+	CHECK(due == std::vector<std::string>({ "low" }));
+}
+
+GAB_TEST(scheduler_bandwidth_budget_skips_low_priority)
+{
+	PublishScheduler scheduler;
+	scheduler.set_bandwidth_limit(1000.0);
+	scheduler.add_topic("low", 1.0, 0, 0.0);
+	scheduler.add_topic("high", 1.0, 1, 0.0);
+
+	// sizes are unknown until first published, so both topics are admitted
+	std::vector<std::string> due;
+	scheduler.collect_due(10.0, due);
+	REQUIRE(due.size() == 2);
+	scheduler.record_published("high", 600);
+	scheduler.record_published("low", 600);
+
+	// one second refills 1000 bytes of the 1200 spent: only the high priority topic fits
+	scheduler.collect_due(11.0, due);
+	CHECK(due == std::vector<std::string>({ "high" }));
+	CHECK(scheduler.get_topic("low")->n_skipped == 1);
+	CHECK(scheduler.get_topic("high")->n_skipped == 0);
+	scheduler.record_published("high", 600);
+
+	// while high priority traffic uses most of the budget the low priority topic keeps being degraded
+	scheduler.collect_due(12.0, due);
+	CHECK(due == std::vector<std::string>({ "high" }));
+	CHECK(scheduler.get_topic("low")->n_skipped == 2);
+	scheduler.record_published("high", 600);
+
+	// without competition the low priority topic fits again
+	scheduler.remove_topic("high");
+	scheduler.collect_due(13.0, due);
+	CHECK(due == std::vector<std::string>({ "low" }));
+}
+
+GAB_TEST(scheduler_full_budget_admits_oversized_message)
+{
+	PublishScheduler scheduler;
+	scheduler.set_bandwidth_limit(100.0);
+	scheduler.add_topic("a", 1.0, 0, 0.0);
+
+	std::vector<std::string> due;
+	scheduler.collect_due(0.0, due);
+	scheduler.record_published("a", 500);
+
+	// the bucket never holds more than one second of bandwidth, so a full bucket must still admit the topic
+	scheduler.collect_due(100.0, due);
+	CHECK(due == std::vector<std::string>({ "a" }));
+}
+
+GAB_TEST(scheduler_tracks_average_message_size)
+{
+	PublishScheduler scheduler;
+	scheduler.add_topic("a", 1.0, 0, 0.0);
+
+	scheduler.record_published("a", 100);
+	CHECK(scheduler.get_topic("a")->avg_bytes == 100.0);
+	CHECK(scheduler.get_topic("a")->n_published == 1);
+
+	scheduler.record_published("a", 200);
+	CHECK(scheduler.get_topic("a")->avg_bytes > 100.0);
+	CHECK(scheduler.get_topic("a")->avg_bytes < 200.0);
+
+	CHECK(scheduler.remove_topic("a"));
+	CHECK(!scheduler.remove_topic("a"));
+}
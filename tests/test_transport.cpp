@@ -0,0 +1,351 @@
+#include <thread>
+
+#include "test.h"
+#include "transport.h"
+
+using namespace gab;
+
+// ports used by the transport tests (distinct from the default publisher/listener ports, so a running bridge does not interfere)
+static const uint16_t TEST_LISTENER_PORT = 21102;
+static const uint16_t TEST_PUBLISHER_PORT = 21101;
+static const uint16_t TEST_REQUEST_PORT = 21103;
+static const int TEST_REPLY_TIMEOUT = 2000;  // in milliseconds
+
+/* NullHandler Class
+*
+*  Description: A RequestHandler that accepts every request (used where only the sockets are of interest).
+*****************************************************************************************************************************************/
+class NullHandler : public RequestHandler {
+public:
+	void notify(json& request, std::string& parse_errors) override {}
+	void notify_batch(json& request, std::vector<std::string>& event_errors) override {}
+
+	std::shared_ptr<const std::string> get_snapshot(const std::string& topic) const override { return nullptr; }
+	int64_t grant_credit(const std::string& topic, int64_t n) override { return n; }
+	uint64_t get_epoch() const override { return 0; }
+};
+
+/* ScriptedHandler Class
+*
+*  Description: A RequestHandler with canned behavior: events with "reject" set are rejected, an event without a "value" raises a JSON
+*               error (as decoding an unexpected request does in Godot), credit for topic "refused" is refused, and snapshots are served
+*               from a map.
+*****************************************************************************************************************************************/
+class ScriptedHandler : public RequestHandler {
+private:
+	static std::string check_event(const json& event) {
+		event.at("value");
+		return event.value("reject", false) ? "rejected event" : "";
+	}
+
+public:
+	std::map<std::string, std::shared_ptr<const std::string>> snapshots;
+
+	void notify(json& request, std::string& parse_errors) override {
+		parse_errors = check_event(request[MSG_DATA][EVENT]);
+	}
+
+	void notify_batch(json& request, std::vector<std::string>& event_errors) override {
+		for (const json& event : request[MSG_DATA][EVENTS]) {
+			event_errors.push_back(check_event(event));
+		}
+	}
+
+	std::shared_ptr<const std::string> get_snapshot(const std::string& topic) const override {
+		std::map<std::string, std::shared_ptr<const std::string>>::const_iterator it = snapshots.find(topic);
+		return (it != snapshots.end()) ? it->second : nullptr;
+	}
+
+	int64_t grant_credit(const std::string& topic, int64_t n) override {
+		if (topic == "refused") {
+			throw GodotAiBridgeException("credit refused");
+		}
+		return n + 1;
+	}
+
+	uint64_t get_epoch() const override { return 3; }
+};
+
+/* ListenerFixture Class
+*
+*  Description: Runs a Listener on its own thread and exchanges raw requests with it through a REQ socket (so malformed requests can be
+*               sent). The listener thread is stopped and joined even if a test case ends early.
+*****************************************************************************************************************************************/
+class ListenerFixture {
+private:
+	zmq::context_t context;
+	Listener listener;
+	std::thread listener_thread;
+	zmq::socket_t requester;
+
+public:
+	explicit ListenerFixture(RequestHandler& handler)
+		: context(),
+		  listener(context, DEFAULT_LISTENER_OPTIONS, TEST_REQUEST_PORT, handler),
+		  listener_thread(std::ref(listener)),
+		  requester(context, ZMQ_REQ)
+	{
+		set_options(requester, { {ZMQ_RCVTIMEO, TEST_REPLY_TIMEOUT}, {ZMQ_LINGER, 0} });
+		requester.connect(construct_endpoint("127.0.0.1", TEST_REQUEST_PORT));
+	}
+
+	~ListenerFixture() {
+		listener.stop();
+		listener_thread.join();
+	}
+
+	json exchange(const std::string& request) {
+		zmq::message_t request_message = construct_message(request);
+		requester.send(request_message, zmq::send_flags::none);
+
+		zmq::message_t reply;
+		if (!requester.recv(reply, zmq::recv_flags::none)) {
+			throw GodotAiBridgeException("no reply from listener");
+		}
+
+		const char* p_begin = static_cast<const char*>(reply.data());
+		return json::parse(p_begin, p_begin + reply.size());
+	}
+};
+
+// subscriptions reach the publisher asynchronously, so a publisher needs some time to learn about a consumer's (un)subscription
+static bool publish_until(Publisher& publisher, const std::string& topic, bool is_sent)
+{
+	for (int i = 0; i < 400; i++) {
+		if (publisher.publish(topic, "{}") == is_sent) {
+			return true;
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(5));
+	}
+
+	return false;
+}
+
+static std::string get_reason(const json& reply)
+{
+	return reply[MSG_DATA].value(REPLY_REASON, "");
+}
+
+GAB_TEST(transport_recreates_listener_on_same_port)
+{
+	zmq::context_t context;
+	NullHandler handler;
+
+	// closed sockets release their endpoints asynchronously, so each listener must still bind immediately after the previous one
+	for (int i = 0; i < 200; i++) {
+		Listener listener(context, DEFAULT_LISTENER_OPTIONS, TEST_LISTENER_PORT, handler);
+	}
+}
+
+GAB_TEST(transport_failed_bind_releases_socket)
+{
+	// the context is terminated at the end of each scope, which blocks forever if a failed constructor leaked its socket
+	{
+		zmq::context_t context;
+		Publisher publisher(context, DEFAULT_PUBLISHER_OPTIONS, TEST_PUBLISHER_PORT);
+
+		CHECK_THROWS(Publisher(context, DEFAULT_PUBLISHER_OPTIONS, TEST_PUBLISHER_PORT), zmq::error_t);
+	}
+
+	{
+		zmq::context_t context;
+		NullHandler handler;
+		Listener listener(context, DEFAULT_LISTENER_OPTIONS, TEST_LISTENER_PORT, handler);
+
+		CHECK_THROWS(Listener(context, DEFAULT_LISTENER_OPTIONS, TEST_LISTENER_PORT, handler), zmq::error_t);
+	}
+}
+
+GAB_TEST(transport_checks_cpus_before_pinning)
+{
+	CHECK(!is_usable_cpu(-1));
+	CHECK(!is_usable_cpu(100000));
+
+	bool has_usable_cpu = false;
+	for (unsigned cpu = 0; cpu < std::max(std::thread::hardware_concurrency(), 1u); cpu++) {
+		has_usable_cpu = has_usable_cpu || is_usable_cpu(int(cpu));
+	}
+	CHECK(has_usable_cpu);
+}
+
+GAB_TEST(transport_ignores_unusable_io_thread_cpus)
+{
+	PerformanceOptions options;
+	options.io_threads = 1;
+	options.io_thread_cpus = { -1, 500, 100000 };
+
+	// zmq aborts the process when its io threads start if an invalid CPU was passed on
+	zmq::context_t context;
+	set_context_options(context, options);
+
+	// the socket's io thread is running (nobody is subscribed, so the message is dropped)
+	Publisher publisher(context, DEFAULT_PUBLISHER_OPTIONS, TEST_PUBLISHER_PORT);
+	CHECK(!publisher.publish("topic", "{}"));
+}
+
+GAB_TEST(publisher_reports_socket_errors_separately_from_drops)
+{
+	zmq::context_t context;
+
+	std::map<int, int> options = DEFAULT_PUBLISHER_OPTIONS;
+	options[ZMQ_SNDHWM] = 1;
+	options[ZMQ_XPUB_NODROP] = 1;
+	Publisher publisher(context, options, TEST_PUBLISHER_PORT);
+
+	// a subscriber that never reads fills its queue, so later sends fail with EAGAIN
+	zmq::socket_t subscriber(context, ZMQ_SUB);
+	set_options(subscriber, { {ZMQ_RCVHWM, 1}, {ZMQ_LINGER, 0} });
+	subscriber.setsockopt(ZMQ_SUBSCRIBE, "", 0);
+	subscriber.connect(construct_endpoint("127.0.0.1", TEST_PUBLISHER_PORT));
+	REQUIRE(publish_until(publisher, "topic", true));
+
+	std::string payload(4096, 'x');
+	bool is_sent = true;
+	for (int i = 0; i < 5000 && is_sent; i++) {
+		is_sent = publisher.publish("topic", payload);
+		if (is_sent) {
+			std::this_thread::sleep_for(std::chrono::microseconds(100));
+		}
+	}
+	CHECK(!is_sent);
+
+	// a terminated context is an error (not counted as a drop). sockets notice the shutdown the next time they process commands, which
+	// sends may postpone for up to a millisecond.
+	zmq_ctx_shutdown(static_cast<void*>(context));
+	std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	CHECK_THROWS(publisher.publish("topic", payload), GodotAiBridgeException);
+}
+
+GAB_TEST(listener_replies_to_events)
+{
+	ScriptedHandler handler;
+	ListenerFixture fixture(handler);
+
+	json reply = fixture.exchange(R"({"data": {"event": {"value": 1}}})");
+	CHECK(is_success_reply(reply));
+	CHECK(reply[MSG_HEADER][SEQNO] == 1);
+	CHECK(reply[MSG_HEADER][EPOCH] == 3);
+
+	reply = fixture.exchange(R"({"data": {"event": {"value": 1, "reject": true}}})");
+	CHECK(reply[MSG_DATA][REPLY_STATUS] == STATUS_ERROR);
+	CHECK(get_reason(reply) == "rejected event");
+	CHECK(reply[MSG_HEADER][SEQNO] == 2);
+}
+
+GAB_TEST(listener_splices_snapshots_into_query_replies)
+{
+	ScriptedHandler handler;
+	std::string snapshot = R"({"header": {"seqno": 7}, "data": {"position": [1.5, -2], "name": "agent \"1\""}})";
+	handler.snapshots["state"] = std::make_shared<const std::string>(snapshot);
+
+	ListenerFixture fixture(handler);
+
+	json reply = fixture.exchange(R"({"data": {"query": "state"}})");
+	CHECK(is_success_reply(reply));
+	CHECK(reply[MSG_HEADER][SEQNO] == 1);
+	CHECK(reply[MSG_DATA][REPLY_TOPIC] == "state");
+	CHECK(reply[MSG_DATA][REPLY_MESSAGE] == json::parse(snapshot));
+
+	reply = fixture.exchange(R"({"data": {"query": "missing"}})");
+	CHECK(reply[MSG_DATA][REPLY_STATUS] == STATUS_ERROR);
+	CHECK(get_reason(reply) == "no message has been published on topic missing");
+	CHECK(!reply[MSG_DATA].contains(REPLY_MESSAGE));
+}
+
+GAB_TEST(listener_reports_batch_results_in_event_order)
+{
+	ScriptedHandler handler;
+	ListenerFixture fixture(handler);
+
+	json reply = fixture.exchange(R"({"data": {"events": [{"value": 1}, {"value": 2, "reject": true}, {"value": 3}]}})");
+	CHECK(reply[MSG_DATA][REPLY_STATUS] == STATUS_ERROR);
+	CHECK(get_reason(reply) == "1 of 3 events rejected");
+
+	const json& results = reply[MSG_DATA][REPLY_RESULTS];
+	REQUIRE(results.size() == 3);
+	CHECK(is_success_reply(json{ {MSG_DATA, results[0]} }));
+	CHECK(results[1][REPLY_STATUS] == STATUS_ERROR);
+	CHECK(results[1][REPLY_REASON] == "rejected event");
+	CHECK(is_success_reply(json{ {MSG_DATA, results[2]} }));
+
+	reply = fixture.exchange(R"({"data": {"events": []}})");
+	CHECK(is_success_reply(reply));
+	CHECK(reply[MSG_DATA][REPLY_RESULTS] == json::array());
+}
+
+GAB_TEST(listener_replies_to_credit_grants)
+{
+	ScriptedHandler handler;
+	ListenerFixture fixture(handler);
+
+	json reply = fixture.exchange(R"({"data": {"credit": 4, "topic": "state"}})");
+	CHECK(is_success_reply(reply));
+	CHECK(reply[MSG_DATA][REPLY_CREDIT] == 5);
+
+	reply = fixture.exchange(R"({"data": {"credit": 4, "topic": 1}})");
+	CHECK(reply[MSG_DATA][REPLY_STATUS] == STATUS_ERROR);
+	CHECK(get_reason(reply) == "credit topic must be a string");
+
+	reply = fixture.exchange(R"({"data": {"credit": 4, "topic": "refused"}})");
+	CHECK(reply[MSG_DATA][REPLY_STATUS] == STATUS_ERROR);
+	CHECK(get_reason(reply) == "credit refused");
+	CHECK(!reply[MSG_DATA].contains(REPLY_CREDIT));
+}
+
+GAB_TEST(listener_rejects_malformed_requests_and_keeps_serving)
+{
+	ScriptedHandler handler;
+	ListenerFixture fixture(handler);
+
+	json reply = fixture.exchange(R"({"data": {"event": )");
+	CHECK(reply[MSG_DATA][REPLY_STATUS] == STATUS_ERROR);
+	CHECK(get_reason(reply).find("parse error") != std::string::npos);
+
+	// JSON errors raised while handling a well-formed request are reported the same way
+	reply = fixture.exchange(R"({"data": {"event": {"other": 1}}})");
+	CHECK(reply[MSG_DATA][REPLY_STATUS] == STATUS_ERROR);
+	CHECK(get_reason(reply).find("value") != std::string::npos);
+
+	reply = fixture.exchange(R"({"data": {"events": [{"value": 1}, {"other": 1}]}})");
+	CHECK(reply[MSG_DATA][REPLY_STATUS] == STATUS_ERROR);
+	CHECK(!reply[MSG_DATA].contains(REPLY_RESULTS));
+
+	reply = fixture.exchange(R"({"data": {"event": {"value": 1}}})");
+	CHECK(is_success_reply(reply));
+	CHECK(reply[MSG_HEADER][SEQNO] == 4);
+}
+
+GAB_TEST(publisher_drops_messages_nobody_subscribed_to)
+{
+	zmq::context_t context;
+	Publisher publisher(context, DEFAULT_PUBLISHER_OPTIONS, TEST_PUBLISHER_PORT);
+
+	uint64_t seqno = publisher.get_seqno();
+	CHECK(!publisher.publish("a", "{}"));
+	CHECK(publisher.get_seqno() == seqno + 1);
+
+	zmq::socket_t subscriber(context, ZMQ_SUB);
+	set_options(subscriber, { {ZMQ_LINGER, 0} });
+	subscriber.setsockopt(ZMQ_SUBSCRIBE, "a ", 2);
+	subscriber.connect(construct_endpoint("127.0.0.1", TEST_PUBLISHER_PORT));
+
+	REQUIRE(publish_until(publisher, "a", true));
+	CHECK(!publisher.publish("b", "{}"));
+	CHECK(!publisher.publish("ab", "{}"));
+
+	{
+		zmq::socket_t all_subscriber(context, ZMQ_SUB);
+		set_options(all_subscriber, { {ZMQ_LINGER, 0} });
+		all_subscriber.setsockopt(ZMQ_SUBSCRIBE, "", 0);
+		all_subscriber.connect(construct_endpoint("127.0.0.1", TEST_PUBLISHER_PORT));
+
+		CHECK(publish_until(publisher, "b", true));
+	}
+
+	// closing a consumer's socket removes its subscriptions (the other consumer's remain)
+	CHECK(publish_until(publisher, "b", false));
+	CHECK(publisher.publish("a", "{}"));
+
+	subscriber.setsockopt(ZMQ_UNSUBSCRIBE, "a ", 2);
+	CHECK(publish_until(publisher, "a", false));
+}
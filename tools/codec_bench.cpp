@@ -0,0 +1,175 @@
+/* Godot-AI-Bridge (GAB) - Codec Microbenchmark
+*
+*  Description: Measures the engine-independent marshaling core (libgab_core) without Godot: decoding of JSON requests through the
+*               ValueVisitor interface, encoding of values to JSON, and serialization of the resulting messages. Suitable for running
+*               under perf or the sanitizers (see SConstruct "core" target and "sanitize" option).
+*
+*  Usage: gab_codec_bench [--iterations N] [--elements N] [--hint auto|generic|int|real|byte]
+*****************************************************************************************************************************************/
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+
+#include "codec.h"
+#include "protocol.h"
+
+using namespace std;
+using namespace gab;
+
+using clock_type = std::chrono::steady_clock;
+
+struct BenchOptions {
+	size_t n_iterations = 10000;
+	size_t n_elements = 1024;  // elements in each numeric array of the benchmark message
+	ArrayHint hint = ARRAY_HINT_AUTO;
+};
+
+/* NullVisitor Class
+*
+*  Description: A ValueVisitor that only counts what it visits (isolates decoding cost from any target value representation).
+*****************************************************************************************************************************************/
+class NullVisitor : public ValueVisitor {
+public:
+	size_t n_visited = 0;
+
+	void visit_nil() override { n_visited++; }
+	void visit_bool(bool v) override { n_visited++; }
+	void visit_int(int64_t v) override { n_visited++; }
+	void visit_real(double v) override { n_visited++; }
+	void visit_string(const std::string& v) override { n_visited++; }
+
+	void begin_array(size_t size) override { n_visited++; }
+	void end_array() override {}
+
+	void begin_dictionary(size_t size) override { n_visited++; }
+	void visit_key(const std::string& key) override {}
+	void end_dictionary() override {}
+
+	void visit_int_array(const int32_t* p_elements, size_t size) override { n_visited += size; }
+	void visit_real_array(const float* p_elements, size_t size) override { n_visited += size; }
+	void visit_byte_array(const uint8_t* p_elements, size_t size) override { n_visited += size; }
+};
+
+static void print_usage()
+{
+	std::cerr << "usage: gab_codec_bench [--iterations N] [--elements N] [--hint auto|generic|int|real|byte]" << std::endl;
+}
+
+static bool parse_args(int argc, char** argv, BenchOptions& options_out)
+{
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		bool has_value = i + 1 < argc;
+
+		if (arg == "--iterations" && has_value) {
+			options_out.n_iterations = std::max<size_t>(std::stoul(argv[++i]), 1);
+		}
+		else if (arg == "--elements" && has_value) {
+			options_out.n_elements = std::stoul(argv[++i]);
+		}
+		else if (arg == "--hint" && has_value) {
+			options_out.hint = convert_array_hint(argv[++i]);
+		}
+		else {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// a message resembling typical environment state (scalars, an observation vector and a small image)
+static json create_message(size_t n_elements)
+{
+	json message;
+	json& data = message[MSG_DATA];
+
+	data["id"] = 1;
+	data["name"] = "agent";
+	data["alive"] = true;
+	data["health"] = 0.75;
+
+	json& position = data["position"];
+	for (size_t i = 0; i < n_elements; i++) {
+		position.push_back(0.5 * double(i));
+	}
+
+	json& pixels = data["pixels"];
+	for (size_t i = 0; i < n_elements; i++) {
+		pixels.push_back(int(i % 256));
+	}
+
+	return message;
+}
+
+template <class Func>
+static double measure_ns(size_t n_iterations, Func func)
+{
+	auto start = clock_type::now();
+	for (size_t i = 0; i < n_iterations; i++) {
+		func();
+	}
+	auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(clock_type::now() - start);
+
+	return double(elapsed.count()) / double(n_iterations);
+}
+
+int main(int argc, char** argv)
+{
+	BenchOptions options;
+	try {
+		if (!parse_args(argc, argv, options)) {
+			print_usage();
+			return 1;
+		}
+	}
+	catch (std::exception& e) {
+		std::cerr << e.what() << std::endl;
+		print_usage();
+		return 1;
+	}
+
+	json message = create_message(options.n_elements);
+	std::string serialized = message.dump();
+
+	NullVisitor visitor;
+	size_t n_bytes = 0;
+
+	double parse_ns = 0, decode_ns = 0, encode_ns = 0, dump_ns = 0;
+	try {
+		parse_ns = measure_ns(options.n_iterations, [&]() {
+			n_bytes += json::parse(serialized).size();
+		});
+
+		decode_ns = measure_ns(options.n_iterations, [&]() {
+			decode_json(message, visitor, options.hint);
+		});
+
+		encode_ns = measure_ns(options.n_iterations, [&]() {
+			json marshaler;
+			encode_value(JsonValue(message, options.hint), marshaler);
+			n_bytes += marshaler.size();
+		});
+
+		dump_ns = measure_ns(options.n_iterations, [&]() {
+			n_bytes += message.dump().size();
+		});
+	}
+	catch (std::exception& e) {
+		// e.g., a forced byte array hint with out of range elements
+		std::cerr << e.what() << std::endl;
+		return 1;
+	}
+
+	std::cout << "message size: " << serialized.size() << " bytes (" << options.n_elements << " elements per array)" << std::endl;
+	std::cout << "parse:  " << parse_ns / 1000.0 << " us/msg" << std::endl;
+	std::cout << "decode: " << decode_ns / 1000.0 << " us/msg" << std::endl;
+	std::cout << "encode: " << encode_ns / 1000.0 << " us/msg" << std::endl;
+	std::cout << "dump:   " << dump_ns / 1000.0 << " us/msg" << std::endl;
+
+	// prevents the measured work from being optimized away
+	std::cerr << "(" << visitor.n_visited << " values visited, " << n_bytes << " bytes)" << std::endl;
+
+	return 0;
+}
@@ -0,0 +1,151 @@
+/* Godot-AI-Bridge (GAB) - Load Generator
+*
+*  Description: Sends action requests to a running GAB environment (e.g., the DEMO) as fast as the pipeline allows and reports
+*               throughput and round-trip latency percentiles. Built with libgab_client (see SConstruct "client" target).
+*
+*  Usage: gab_loadgen [--host HOST] [--port PORT] [--requests N] [--agents N] [--pipeline N] [--batch]
+*****************************************************************************************************************************************/
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "gab_client.h"
+
+using namespace std;
+using namespace gab;
+
+using clock_type = std::chrono::steady_clock;
+
+struct LoadOptions {
+	std::string host = DEFAULT_HOST;
+	int port = DEFAULT_LISTENER_PORT;
+	size_t n_requests = 10000;
+	size_t n_agents = 1;  // events per step (one per agent)
+	size_t pipeline = 1;  // maximum number of requests awaiting replies
+	bool is_batched = false;  // one request per step (instead of one request per agent)
+};
+
+static void print_usage()
+{
+	std::cerr << "usage: gab_loadgen [--host HOST] [--port PORT] [--requests N] [--agents N] [--pipeline N] [--batch]" << std::endl;
+}
+
+static bool parse_args(int argc, char** argv, LoadOptions& options_out)
+{
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		bool has_value = i + 1 < argc;
+
+		if (arg == "--host" && has_value) {
+			options_out.host = argv[++i];
+		}
+		else if (arg == "--port" && has_value) {
+			options_out.port = std::stoi(argv[++i]);
+		}
+		else if (arg == "--requests" && has_value) {
+			options_out.n_requests = std::stoul(argv[++i]);
+		}
+		else if (arg == "--agents" && has_value) {
+			options_out.n_agents = std::max<size_t>(std::stoul(argv[++i]), 1);
+		}
+		else if (arg == "--pipeline" && has_value) {
+			options_out.pipeline = std::max<size_t>(std::stoul(argv[++i]), 1);
+		}
+		else if (arg == "--batch") {
+			options_out.is_batched = true;
+		}
+		else {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static double percentile(const std::vector<double>& sorted_values, double p)
+{
+	size_t ndx = size_t(p / 100.0 * double(sorted_values.size()));
+	return sorted_values[std::min(ndx, sorted_values.size() - 1)];
+}
+
+int main(int argc, char** argv)
+{
+	LoadOptions options;
+	if (!parse_args(argc, argv, options)) {
+		print_usage();
+		return 1;
+	}
+
+	try {
+		zmq::context_t zmq_context;
+		ActionSender sender(zmq_context, options.host, options.port, options.pipeline);
+
+		// an unrecognized action value leaves the DEMO environment unchanged
+		std::vector<json> events;
+		for (size_t agent = 1; agent <= options.n_agents; agent++) {
+			events.push_back(json{ {"type", "action"}, {"agent", agent}, {"value", "noop"} });
+		}
+
+		std::unordered_map<uint64_t, clock_type::time_point> send_times;
+		std::vector<double> latencies;  // in microseconds
+		latencies.reserve(options.n_requests);
+
+		auto record_reply = [&](int timeout) {
+			json reply;
+			uint64_t seqno;
+
+			if (!sender.receive(reply, seqno, timeout)) {
+				throw GodotAiBridgeException("timed out waiting for reply");
+			}
+
+			auto search = send_times.find(seqno);
+			latencies.push_back(std::chrono::duration<double, std::micro>(clock_type::now() - search->second).count());
+			send_times.erase(search);
+		};
+
+		clock_type::time_point start = clock_type::now();
+
+		size_t n_sent = 0;
+		while (n_sent < options.n_requests) {
+
+			// collect a reply before exceeding the pipeline depth, so every reply is timed
+			if (sender.get_in_flight() >= options.pipeline) {
+				record_reply(DEFAULT_CLIENT_TIMEOUT);
+			}
+
+			uint64_t seqno = options.is_batched ? sender.send_events(events) : sender.send_event(events[n_sent % events.size()]);
+			send_times[seqno] = clock_type::now();
+			n_sent++;
+		}
+
+		while (sender.get_in_flight() > 0) {
+			record_reply(DEFAULT_CLIENT_TIMEOUT);
+		}
+
+		double elapsed = std::chrono::duration<double>(clock_type::now() - start).count();
+		size_t n_events = options.is_batched ? n_sent * options.n_agents : n_sent;
+
+		if (latencies.empty()) {
+			std::cout << "requests: 0" << std::endl;
+			return 0;
+		}
+
+		std::sort(latencies.begin(), latencies.end());
+
+		std::cout << "requests: " << n_sent << " (" << n_sent / elapsed << " requests/sec)" << std::endl;
+		std::cout << "events: " << n_events << " (" << n_events / elapsed << " events/sec)" << std::endl;
+		std::cout << "p50: " << percentile(latencies, 50) << " us" << std::endl;
+		std::cout << "p90: " << percentile(latencies, 90) << " us" << std::endl;
+		std::cout << "p99: " << percentile(latencies, 99) << " us" << std::endl;
+		std::cout << "max: " << latencies.back() << " us" << std::endl;
+	}
+	catch (std::exception& e) {
+		std::cerr << "gab_loadgen: " << e.what() << std::endl;
+		return 1;
+	}
+
+	return 0;
+}